@@ -1,23 +1,6 @@
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-#include <stdio.h>
-#include <unistd.h>
-
-// Platform-specific includes
-#ifdef _WIN32
-    #include <conio.h>
-    #include <windows.h>
-    #include <mmsystem.h>
-    #define CLEAR "cls"
-    #define msleep(x) Sleep(x)
-#else
-    #include <termios.h>
-    #include <unistd.h>
-    #include <stdio.h>
-    #define CLEAR "clear"
-    #define msleep(x) usleep((x) * 1000)
+#include "Game.h"
 
+#ifndef _WIN32
     // Linux implementation of _getch
     int _getch(void) {
         struct termios oldt, newt;
@@ -32,336 +15,87 @@
     }
 #endif
 
-
-// Constants
-#define ROWS 20
-#define COLS 20
-#define MAX_CROCODILES 4
-#define MAX_SNAKES 2
-#define SMALL_MAP 0
-#define BIG_MAP 1
-#define ENEMY_EASY 0
-#define ENEMY_HARD 1
-#define POWER_WEAK 0
-#define POWER_STRONG 1
-#define MAX_NAME_LENGTH 20
-#define MAX_MESSAGE_LENGTH 10
-
-// ANSI Color codes
-#define RESET   "\x1b[0m"
-#define RED     "\x1b[31m"
-#define GREEN   "\x1b[32m"
-#define YELLOW  "\x1b[33m"
-#define BLUE    "\x1b[34m"
-#define MAGENTA "\x1b[35m"
-#define CYAN    "\x1b[36m"
-#define WHITE   "\x1b[37m"
-#define BOLD    "\x1b[1m"
-#define UNDERLINE "\x1b[4m"
-
-// Type definitions
-typedef enum {
-    SAFE_LAND,
-    THORNS,
-    WALL,
-    CROCODILE,
-    SNAKE,
-    FOOD,
-    GUN,
-    BULLET,
-    AXE,
-    HEALTH_PACK,
-    PORTAL,
-    BOSS,
-    CHECKPOINT
-} CellType;
-
-// Forward declarations of structures
-typedef struct Node Node;
-typedef struct InventoryItem InventoryItem;
-typedef struct QueueNode QueueNode;
-typedef struct Queue Queue;
-typedef struct StackNode StackNode;
-typedef struct Stack Stack;
-typedef struct Player Player;
-typedef struct GameConfig GameConfig;
-typedef struct DifficultyNode DifficultyNode;
-typedef struct Snake Snake;
-typedef struct Crocodile Crocodile;
-
-// Structure definitions
-struct Node {
-    int x, y;
-    CellType type;
-    int lastShootTime;
-    int health;
-    Node *up, *down, *left, *right;
-};
-
-struct InventoryItem {
-    char name[20];
-    int quantity;
-    InventoryItem *next;
-};
-
-struct QueueNode {
-    Node *position;
-    QueueNode *next;
-};
-
-struct Queue {
-    QueueNode *front, *rear;
-};
-
-typedef struct CheckpointNode {
-    Node* position;
-    struct CheckpointNode* next;
-} CheckpointNode;
-
-typedef struct CheckpointStack {
-    CheckpointNode* top;
-    int size;  // Keep track of size for the 3-checkpoint limit
-} CheckpointStack;
-
-struct Player {
-    char name[20];
-    Node *position;
-    int health;
-    int score;
-    InventoryItem *inventory;
-    int hasGun;
-    char message[100];
-    int readyForBoss;
-    CheckpointStack checkpoints;  // New field for checkpoint stack
-};
-typedef struct Boss {
-    Node* position;
-    int health;
-    int attackCooldown;
-    int phaseNumber;  // For different attack patterns
-    int isActive;
-    int moveCooldown;
-} Boss;
-
-struct GameConfig {
-    int mapSize;
-    int enemyCount;
-    int enemyPower;
-    const char* mapData;
-    int snakeHealth;
-    int crocodileHealth;
-    int snakeDamage;
-    int crocodileDamage;
-    int snakeCount;
-    int crocodileCount;
-};
-
-struct DifficultyNode {
-    char* prompt;
-    DifficultyNode* left;
-    DifficultyNode* right;
-    int level;
-};
-
-struct Snake {
-    Node* position;
-    int health;
-    int shootCooldown;
-};
-
-struct Crocodile {
-    Node* position;
-    Queue movementQueue;
-};
-typedef struct HighScoreNode {
-    char name[MAX_NAME_LENGTH];
-    int score;
-    struct HighScoreNode *next;
-} HighScoreNode;
-
-HighScoreNode *head = NULL;
-// Function prototypes
-// Node management
-Node* createNode(int x, int y, CellType type);
-void initGraphFromMap(Node* graph[ROWS][COLS], Player *player, const char* map);
-
-// Queue operations
-void initQueue(Queue *queue);
-void enqueue(Queue *queue, Node *position);
-Node* dequeue(Queue *queue);
-
-// Stack operations
-void handleCheckpoint(Player* player, Node* currentNode);
-void pushCheckpoint(CheckpointStack* stack, Node* position);
-Node* popCheckpoint(CheckpointStack* stack);
-void clearCheckpointStack(CheckpointStack* stack);
-
-// Inventory management
-void addInventoryItem(Player *player, const char *itemName);
-int removeInventoryItem(Player *player, const char *itemName);
-void displayInventory(Player *player);
-void useHealthPack(Player *player);
-
-// Player actions
-void movePlayer(Player *player, char direction, Node *graph[ROWS][COLS]);
-void shootBullet(Player *player, Node *graph[ROWS][COLS], char direction);
-void breakThorns(Player *player, Node *graph[ROWS][COLS], char direction);
-
-// Enemy management
-void initCrocodiles(void);
-void setupCrocodiles(Node* graph[ROWS][COLS], GameConfig* config);
-void moveAllCrocodiles(Node* graph[ROWS][COLS], Player* player);
-void checkCrocodileAttack(Node* crocodileNode, Player* player);
-void cleanupCrocodiles(void);
-void initializeBoss(Node* graph[ROWS][COLS], Player* player, const char* bossMap);
-void moveBoss(Node* graph[ROWS][COLS], Player* player);
-void bossAttackPattern(Node* graph[ROWS][COLS], Player* player);
-
-
-
-
-
-void initSnakes(void);
-void setupSnakes(Node* graph[ROWS][COLS], GameConfig* config);
-void snakeShoot(Node* graph[ROWS][COLS], Player* player, Snake* snake);
-void handleAllSnakesShooting(Node* graph[ROWS][COLS], Player* player);
-void cleanupSnakes(void);
-
-// Game setup and control
-DifficultyNode* createDifficultyNode(char* prompt, int level);
-DifficultyNode* buildDifficultyTree(void);
-GameConfig* getDifficultyChoices(DifficultyNode* root);
-void freeDifficultyTree(DifficultyNode* root);
-void initializeGame(Node* graph[ROWS][COLS], Player* player, GameConfig* config);
-void gameLoop(Node* graph[ROWS][COLS], Player *player);
-void displayGraph(Node* graph[ROWS][COLS], Player *player);
-int dangerWarning(Player *player, Node *graph[ROWS][COLS]);
-
 // Global variables
-GameConfig* config;
-Crocodile crocodiles[MAX_CROCODILES];
-Snake snakes[MAX_SNAKES];
-int activeCrocodiles;
-int activeSnakes;
-
-//HIGH Score
-void addHighScore(const char *name, int score);
-void displayHighScores();
+Renderer screen;  // The terminal front-end's frame; sessions never touch it
 
 
 
-Boss boss;
-
 void initQueue(Queue *queue) {
-    queue->front = queue->rear = NULL;
+    queue->front = 0;
+    queue->count = 0;
 }
 
-void enqueue(Queue *queue, Node *position) {
-    QueueNode *newNode = (QueueNode*)malloc(sizeof(QueueNode));
-    newNode->position = position;
-    newNode->next = NULL;
-
-    if (queue->rear == NULL) {
-        queue->front = queue->rear = newNode;
-        return;
-    }
-
-    queue->rear->next = newNode;
-    queue->rear = newNode;
+void enqueue(Queue *queue, int position) {
+    if (queue->count == PATROL_LENGTH) return;  // Full patrol
+    queue->cells[(queue->front + queue->count) % PATROL_LENGTH] = position;
+    queue->count++;
 }
 
-Node* dequeue(Queue *queue) {
-    if (queue->front == NULL) return NULL;
-
-    QueueNode *temp = queue->front;
-    Node *position = temp->position;
-    queue->front = queue->front->next;
+int dequeue(Queue *queue) {
+    if (queue->count == 0) return NO_CELL;
 
-    if (queue->front == NULL) queue->rear = NULL;
-
-    free(temp);
+    int position = queue->cells[queue->front];
+    queue->front = (queue->front + 1) % PATROL_LENGTH;
+    queue->count--;
     return position;
 }
 
 
 
-Node* createNode(int x, int y, CellType type) {
-    Node* newNode = (Node*)malloc(sizeof(Node));
-    newNode->x = x;
-    newNode->y = y;
-    newNode->type = type;
-    newNode->up = newNode->down = newNode->left = newNode->right = NULL;
-    return newNode;
-}
-
-void initCheckpointStack(CheckpointStack* stack) {
-    stack->top = NULL;
+void initCheckpointStack(CheckpointStack* stack, int depth) {
+    stack->top = 0;
     stack->size = 0;
+    stack->depth = depth < 1 ? 1 : (depth > MAX_CHECKPOINTS ? MAX_CHECKPOINTS : depth);
 }
 
-// Push checkpoint to stack
-void pushCheckpoint(CheckpointStack* stack, Node* position) {
-    // Create new checkpoint node
-    CheckpointNode* newNode = (CheckpointNode*)malloc(sizeof(CheckpointNode));
-    newNode->position = position;
-    newNode->next = stack->top;
-
-    if (stack->size >= 3) {
-        CheckpointNode* current = stack->top;
-
-        // Find second-to-last node
-        while (current->next->next != NULL) {
-            current = current->next;
-        }
-
-        // Free last node and set new last node's next to NULL
-        free(current->next);
-        current->next = NULL;
-    }else {
-    stack->size++;
-    }
-
-
-    // Add new checkpoint at top
-    stack->top = newNode;
+// Push checkpoint to stack, overwriting the oldest one when full
+void pushCheckpoint(CheckpointStack* stack, const Player* player) {
+    Checkpoint* checkpoint = &stack->entries[stack->top];
+    checkpoint->position = player->position;
+    checkpoint->health = player->health;
+    checkpoint->score = player->score;
+    memcpy(checkpoint->inventory, player->inventory, sizeof(checkpoint->inventory));
+    checkpoint->hasGun = player->hasGun;
+
+    stack->top = (stack->top + 1) % stack->depth;
+    if (stack->size < stack->depth) stack->size++;
 }
 
-// Pop checkpoint from stack
-Node* popCheckpoint(CheckpointStack* stack) {
-    if (stack->top == NULL) {
-        return NULL;
+// Pop checkpoint from stack; returns 0 if there is none
+int popCheckpoint(CheckpointStack* stack, Checkpoint* checkpoint) {
+    if (stack->size == 0) {
+        return 0;
     }
 
-    CheckpointNode* temp = stack->top;
-    Node* position = temp->position;
-    stack->top = temp->next;
-    free(temp);
+    stack->top = (stack->top + stack->depth - 1) % stack->depth;
     stack->size--;
-
-    return position;
+    *checkpoint = stack->entries[stack->top];
+    return 1;
 }
 
-// Function to clear checkpoint stack (for cleanup)
+// Function to clear checkpoint stack
 void clearCheckpointStack(CheckpointStack* stack) {
-    while (stack->top != NULL) {
-        CheckpointNode* temp = stack->top;
-        stack->top = stack->top->next;
-        free(temp);
-    }
+    stack->top = 0;
     stack->size = 0;
 }
 
 // Function to handle checkpoint discovery
-void handleCheckpoint(Player* player, Node* currentNode) {
-    pushCheckpoint(&player->checkpoints, currentNode);
-    currentNode->type = SAFE_LAND;  // Replace checkpoint with safe land
+void handleCheckpoint(GameState* game, int cell) {
+    Player* player = &game->player;
+    pushCheckpoint(&player->checkpoints, player);
+    gridSetType(&game->grid, cell, SAFE_LAND);  // Replace checkpoint with safe land
     strcpy(player->message, " Checkpoint sauvegarde! ");
 }
 
+// Put the player back in the state saved at the last checkpoint
 int returnToLastCheckpoint(Player* player) {
-    Node* lastCheckpoint = popCheckpoint(&player->checkpoints);
-    if (lastCheckpoint != NULL) {
-        player->position = lastCheckpoint;
+    Checkpoint lastCheckpoint;
+    if (popCheckpoint(&player->checkpoints, &lastCheckpoint)) {
+        player->position = lastCheckpoint.position;
+        player->health = lastCheckpoint.health;
+        player->score = lastCheckpoint.score;
+        memcpy(player->inventory, lastCheckpoint.inventory, sizeof(player->inventory));
+        player->hasGun = lastCheckpoint.hasGun;
         strcpy(player->message, " Retour au dernier checkpoint! ");
         return 1; // Checkpoint available
     } else {
@@ -399,70 +133,80 @@ DifficultyNode* buildDifficultyTree() {
     return root;
 }
 
+// Built-in maps
+const char* smallMap =
+    "+++++++++++++++\n"
+    "+P C  G      A+\n"
+    "+++++++++++#+++\n"
+    "+A            +\n"
+    "+      G    H +\n"
+    "++#++++++++++++\n"
+    "+ A    #    C +\n"
+    "+      #      +\n"
+    "+      #   A  +\n"
+    "+      #      +\n"
+    "+F  A  #      +\n"
+    "+++++++++++#+++\n"
+    "+ C   G     ##+\n"
+    "+  F   A   # O+\n"
+    "+++++++++++++++";
+
+const char* bigMap =
+    "++++++++++++++++++++\n"
+    "+P  C A     G    A +\n"
+    "+++++++++++++#++++++\n"
+    "+  A  G    #    H  +\n"
+    "+           #####  +\n"
+    "++##++++++++++++++++\n"
+    "+     A         C  +\n"
+    "+      G    F      +\n"
+    "+  A        #####  +\n"
+    "+H    #    A       +\n"
+    "+#+++#++++#+++ +++++\n"
+    "+  C    A          +\n"
+    "+ A    G    ###    +\n"
+    "++++++#+++#+++++++++\n"
+    "+                A +\n"
+    "+  ##   G   F      +\n"
+    "+      A           +\n"
+    "+   H         #####+\n"
+    "+     G   #### # O +\n"
+    "++++++++++++++++++++";
+
 // Function to traverse the tree and get user choices
 GameConfig* getDifficultyChoices(DifficultyNode* root) {
-    config = (GameConfig*)malloc(sizeof(GameConfig));
+    GameConfig* config = (GameConfig*)malloc(sizeof(GameConfig));
     DifficultyNode* current = root;
     int choice;
-
-    // Initialize maps
-    const char* smallMap =
-        "+++++++++++++++\n"
-        "+P C  G      A+\n"
-        "+++++++++++#+++\n"
-        "+A            +\n"
-        "+      G    H +\n"
-        "++#++++++++++++\n"
-        "+ A    #    C +\n"
-        "+      #      +\n"
-        "+      #   A  +\n"
-        "+      #      +\n"
-        "+F  A  #      +\n"
-        "+++++++++++#+++\n"
-        "+ C   G     ##+\n"
-        "+  F   A   # O+\n"
-        "+++++++++++++++";
-
-    const char* bigMap =
-        "++++++++++++++++++++\n"
-        "+P  C A     G    A +\n"
-        "+++++++++++++#++++++\n"
-        "+  A  G    #    H  +\n"
-        "+           #####  +\n"
-        "++##++++++++++++++++\n"
-        "+     A         C  +\n"
-        "+      G    F      +\n"
-        "+  A        #####  +\n"
-        "+H    #    A       +\n"
-        "+#+++#++++#+++ +++++\n"
-        "+  C    A          +\n"
-        "+ A    G    ###    +\n"
-        "++++++#+++#+++++++++\n"
-        "+                A +\n"
-        "+  ##   G   F      +\n"
-        "+      A           +\n"
-        "+   H         #####+\n"
-        "+     G   #### # O +\n"
-        "++++++++++++++++++++";
-
+    int mapSize, enemyCount, enemyPower;
 
     // Level 0: Map Size
     printf("%s\n", current->prompt);
     scanf("%d", &choice);
-    config->mapSize = (choice == 2) ? BIG_MAP : SMALL_MAP;
-    config->mapData = (config->mapSize == BIG_MAP) ? bigMap : smallMap;
+    mapSize = (choice == 2) ? BIG_MAP : SMALL_MAP;
     current = (choice == 2) ? current->right : current->left;
 
     // Level 1: Enemy Count
     printf("%s\n", current->prompt);
     scanf("%d", &choice);
-    config->enemyCount = (choice == 2) ? ENEMY_HARD : ENEMY_EASY;
+    enemyCount = (choice == 2) ? ENEMY_HARD : ENEMY_EASY;
     current = (choice == 2) ? current->right : current->left;
 
     // Level 2: Enemy Power
     printf("%s\n", current->prompt);
     scanf("%d", &choice);
-    config->enemyPower = (choice == 2) ? POWER_STRONG : POWER_WEAK;
+    enemyPower = (choice == 2) ? POWER_STRONG : POWER_WEAK;
+
+    configureGame(config, mapSize, enemyCount, enemyPower);
+    return config;
+}
+
+// Fill a config from the three difficulty choices, without any prompt
+void configureGame(GameConfig* config, int mapSize, int enemyCount, int enemyPower) {
+    config->mapSize = mapSize;
+    config->mapData = (mapSize == BIG_MAP) ? bigMap : smallMap;
+    config->enemyCount = enemyCount;
+    config->enemyPower = enemyPower;
 
     // Configure game parameters based on choices
     if (config->enemyCount == ENEMY_EASY) {
@@ -485,7 +229,24 @@ GameConfig* getDifficultyChoices(DifficultyNode* root) {
         config->crocodileDamage = 15;
     }
 
-    return config;
+    config->projectileSpeed = 1;
+    config->tickRateHz = 30;
+    config->enemyTurnTicks = 6;  // Five enemy turns per second, the pace of the old 200 ms loop
+    config->crocodileBehavior = CROC_CHASE;
+    config->chaseRadius = 8;
+    config->checkpointDepth = 3;
+    config->seed = 1;
+}
+
+// Fill a config from a "small/few/weak" style label, the ones crocs-sim prints
+int configureGameFromLabel(GameConfig* config, const char* label) {
+    char map[16], enemies[16], power[16];
+    if (sscanf(label, "%15[^/]/%15[^/]/%15s", map, enemies, power) != 3) return 0;
+    int mapSize = strcmp(map, "big") == 0 ? BIG_MAP : SMALL_MAP;
+    int enemyCount = strcmp(enemies, "many") == 0 ? ENEMY_HARD : ENEMY_EASY;
+    int enemyPower = strcmp(power, "strong") == 0 ? POWER_STRONG : POWER_WEAK;
+    configureGame(config, mapSize, enemyCount, enemyPower);
+    return 1;
 }
 
 // Function to free the difficulty tree
@@ -497,26 +258,48 @@ void freeDifficultyTree(DifficultyNode* root) {
 }
 
 
-void initCrocodiles() {
+void initCrocodiles(GameState* game) {
     for (int i = 0; i < MAX_CROCODILES; i++) {
-        crocodiles[i].position = NULL;
-        initQueue(&crocodiles[i].movementQueue);
+        game->crocodiles[i].position = NO_CELL;
+        initQueue(&game->crocodiles[i].movementQueue);
     }
 }
-void setupCrocodiles(Node* graph[ROWS][COLS], GameConfig* config) {
+// Patrol a 2x2 square from where the crocodile stands: right, down, left,
+// then back up to its cell, so every step is to a neighbouring cell
+static void resetPatrol(const Grid* grid, Crocodile* crocodile) {
+    int cell = crocodile->position;
+    int right = cellNeighbor(grid, cell, 'd');
+    int rightDown = (right != NO_CELL) ? cellNeighbor(grid, right, 's') : NO_CELL;
+    int down = cellNeighbor(grid, cell, 's');
+
+    initQueue(&crocodile->movementQueue);
+    if (right != NO_CELL)
+        enqueue(&crocodile->movementQueue, right);
+    if (rightDown != NO_CELL)
+        enqueue(&crocodile->movementQueue, rightDown);
+    if (down != NO_CELL)
+        enqueue(&crocodile->movementQueue, down);
+    enqueue(&crocodile->movementQueue, cell);
+}
 
-    activeCrocodiles = config->crocodileCount;
+void setupCrocodiles(GameState* game) {
+    Grid* grid = &game->grid;
+
+    game->activeCrocodiles = game->config.crocodileCount;
 
     // Initialize all crocodiles
-    initCrocodiles();
+    initCrocodiles(game);
+    reserveFlowField(&game->flowField, game->config.chaseRadius);
 
     // Define spawn points
     struct SpawnPoint {
         int x, y;
     };
     struct SpawnPoint spawnPoints[4];
+    int spawnCells[MAX_CROCODILES];
+    int spawnCount = 4;
 
-if (config->mapSize == 1) {
+if (game->config.mapSize == BIG_MAP) {
     struct SpawnPoint temp[] = {
         {3, 4},   // First crocodile
         {11, 4},  // Second crocodile
@@ -540,69 +323,197 @@ if (config->mapSize == 1) {
     }
 }
 
+    // Points marked in the map win over the built-in tables; table points
+    // that fall outside a smaller map are simply left out
+    if (grid->spawns.crocodileCount > 0 || game->config.mapSize == CUSTOM_MAP) {
+        spawnCount = grid->spawns.crocodileCount;
+        memcpy(spawnCells, grid->spawns.crocodiles, sizeof(spawnCells));
+    } else {
+        for (int i = 0; i < spawnCount; i++) {
+            spawnCells[i] = cellIndex(grid, spawnPoints[i].x, spawnPoints[i].y);
+        }
+    }
+
     // Spawn crocodiles at predetermined points
-    for(int i = 0; i < activeCrocodiles; i++) {
-        if (graph[spawnPoints[i].x][spawnPoints[i].y]->type == SAFE_LAND) {
-            graph[spawnPoints[i].x][spawnPoints[i].y]->type = CROCODILE;
-            graph[spawnPoints[i].x][spawnPoints[i].y]->health = config->crocodileHealth;
-
-            crocodiles[i].position = graph[spawnPoints[i].x][spawnPoints[i].y];
-
-            // Setup movement pattern
-            enqueue(&crocodiles[i].movementQueue, crocodiles[i].position);
-            if (crocodiles[i].position->right)
-                enqueue(&crocodiles[i].movementQueue, crocodiles[i].position->right);
-            if (crocodiles[i].position->right && crocodiles[i].position->right->down)
-                enqueue(&crocodiles[i].movementQueue, crocodiles[i].position->right->down);
-            if (crocodiles[i].position->down)
-                enqueue(&crocodiles[i].movementQueue, crocodiles[i].position->down);
+    for(int i = 0; i < game->activeCrocodiles && i < spawnCount; i++) {
+        int cell = spawnCells[i];
+        if (cell != NO_CELL && gridType(grid, cell) == SAFE_LAND) {
+            gridSetType(grid, cell, CROCODILE);
+            gridSetHealth(grid, cell, game->config.crocodileHealth);
+
+            game->crocodiles[i].position = cell;
+            resetPatrol(grid, &game->crocodiles[i]);
         }
     }
 }
 
 
-void moveAllCrocodiles(Node* graph[ROWS][COLS], Player* player) {
-    for (int i = 0; i < activeCrocodiles; i++) {
+// Cells a crocodile can walk through, and the field can spread through
+static int isWalkable(CellType type) {
+    return type == SAFE_LAND || type == CROCODILE;
+}
+
+void reserveFlowField(FlowField* field, int radius) {
+    if (field->distance != NULL && field->radius == radius) return;
+
+    int size = 2 * radius + 1;
+    field->radius = radius;
+    field->size = size;
+    field->distance = (int*)realloc(field->distance, size * size * sizeof(int));
+    field->frontier = (int*)realloc(field->frontier, size * size * sizeof(int));
+    field->target = NO_CELL;
+}
+
+// Breadth-first search outwards from the target over the window around it.
+// Enemies don't block the search, so it only depends on the target and the terrain.
+void updateFlowField(FlowField* field, Grid* grid, int target) {
+    if (target == field->target && grid->terrainVersion == field->terrainVersion) return;
+
+    int size = field->size;
+    int head = 0, tail = 0;
+    static const int steps[4][2] = {{-1,0}, {1,0}, {0,-1}, {0,1}};
+
+    field->target = target;
+    field->terrainVersion = grid->terrainVersion;
+    field->top = cellRow(grid, target) - field->radius;
+    field->left = cellCol(grid, target) - field->radius;
+    memset(field->distance, -1, size * size * sizeof(int));
+
+    int start = field->radius * size + field->radius;
+    field->distance[start] = 0;
+    field->frontier[tail++] = start;
+    while (head < tail) {
+        int current = field->frontier[head++];
+        int row = current / size, col = current % size;
+
+        for (int d = 0; d < 4; d++) {
+            int nextRow = row + steps[d][0], nextCol = col + steps[d][1];
+            if (nextRow < 0 || nextRow >= size || nextCol < 0 || nextCol >= size) continue;
+
+            int next = nextRow * size + nextCol;
+            if (field->distance[next] != -1) continue;
+
+            int cell = cellIndex(grid, field->top + nextRow, field->left + nextCol);
+            if (cell == NO_CELL || !isWalkable(gridType(grid, cell))) continue;
+
+            field->distance[next] = field->distance[current] + 1;
+            field->frontier[tail++] = next;
+        }
+    }
+}
+
+// Steps from a cell to the field's target, or -1 when the cell is outside the
+// window or can't reach the target
+int flowDistance(const FlowField* field, const Grid* grid, int cell) {
+    int row = cellRow(grid, cell) - field->top;
+    int col = cellCol(grid, cell) - field->left;
+    if (field->target == NO_CELL || row < 0 || row >= field->size || col < 0 || col >= field->size) return -1;
+    return field->distance[row * field->size + col];
+}
+
+void cleanupFlowField(FlowField* field) {
+    free(field->distance);
+    free(field->frontier);
+    field->distance = NULL;
+    field->frontier = NULL;
+    field->target = NO_CELL;
+}
+
+// Move a crocodile one step down the flow field.
+// Returns 0 when the crocodile has no trail to follow.
+static int chasePlayer(GameState* game, Crocodile* crocodile) {
+    Grid* grid = &game->grid;
+    int distance = flowDistance(&game->flowField, grid, crocodile->position);
+    if (distance <= 0) return 0;
+
+    static const char directions[4] = {'z', 's', 'q', 'd'};
+    int best = NO_CELL;
+    for (int d = 0; d < 4 && distance > 1; d++) {
+        int next = cellNeighbor(grid, crocodile->position, directions[d]);
+        if (next == NO_CELL || gridHasLayer(grid, next, LAYER_OCCUPIED)) continue;
+        if (flowDistance(&game->flowField, grid, next) == distance - 1) {
+            best = next;
+            break;
+        }
+    }
+
+    // Next to the player, or blocked by another crocodile: stay and bite if close enough
+    if (best != NO_CELL) {
+        gridSetType(grid, crocodile->position, SAFE_LAND);
+        gridSetType(grid, best, CROCODILE);
+        gridSetHealth(grid, best, gridHealth(grid, crocodile->position));
+        crocodile->position = best;
+    }
+    // The old patrol may be far behind now; the next one starts from here
+    resetPatrol(grid, crocodile);
+    checkCrocodileAttack(game, crocodile->position);
+    return 1;
+}
+
+// One step apart, up, down, left or right
+static int cellsAdjacent(const Grid* grid, int a, int b) {
+    return abs(cellRow(grid, a) - cellRow(grid, b)) + abs(cellCol(grid, a) - cellCol(grid, b)) == 1;
+}
+
+void moveAllCrocodiles(GameState* game) {
+    Grid* grid = &game->grid;
+
+    // One field serves every crocodile, so the cost doesn't grow with their number.
+    // With no enemy inside the field's window every crocodile is out of reach
+    // and patrols, so the field isn't even needed.
+    int chasing = game->config.crocodileBehavior == CROC_CHASE &&
+                  gridAnyWithin(grid, game->player.position, game->config.chaseRadius, LAYER_ENEMY);
+    if (chasing) updateFlowField(&game->flowField, grid, game->player.position);
+
+    for (int i = 0; i < game->activeCrocodiles; i++) {
         // Skip if crocodile is dead
-        if (!crocodiles[i].position || crocodiles[i].position->type != CROCODILE) {
+        if (game->crocodiles[i].position == NO_CELL || gridType(grid, game->crocodiles[i].position) != CROCODILE) {
+            continue;
+        }
+
+        // Crocodiles too far away to pick up the trail keep to their patrol
+        if (chasing && chasePlayer(game, &game->crocodiles[i])) {
             continue;
         }
 
-        Node* newPos = dequeue(&crocodiles[i].movementQueue);
-        if (newPos == NULL) {
-            // Reset queue if empty
-            initQueue(&crocodiles[i].movementQueue);
-            enqueue(&crocodiles[i].movementQueue, crocodiles[i].position);
+        int newPos = dequeue(&game->crocodiles[i].movementQueue);
+        if (newPos == NO_CELL || !cellsAdjacent(grid, game->crocodiles[i].position, newPos)) {
+            // Empty, or a blocked cell left a gap in the loop: start again from here
+            resetPatrol(grid, &game->crocodiles[i]);
             continue;
         }
 
         // Move crocodile to new position
-        if (newPos->type == SAFE_LAND) {
-            crocodiles[i].position->type = SAFE_LAND;
-            newPos->type = CROCODILE;
-            newPos->health = crocodiles[i].position->health;
-            crocodiles[i].position = newPos;
+        if (gridType(grid, newPos) == SAFE_LAND) {
+            gridSetType(grid, game->crocodiles[i].position, SAFE_LAND);
+            gridSetType(grid, newPos, CROCODILE);
+            gridSetHealth(grid, newPos, gridHealth(grid, game->crocodiles[i].position));
+            game->crocodiles[i].position = newPos;
 
             // Re-add position to queue for continuous movement
-            enqueue(&crocodiles[i].movementQueue, newPos);
+            enqueue(&game->crocodiles[i].movementQueue, newPos);
 
             // Check for player attack
-            checkCrocodileAttack(newPos, player);
+            checkCrocodileAttack(game, newPos);
         }
     }
 }
 
-void checkCrocodileAttack(Node* crocodileNode, Player* player) {
-    if (!crocodileNode || crocodileNode->type != CROCODILE) return;
+void checkCrocodileAttack(GameState* game, int crocodileCell) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+
+    if (crocodileCell == NO_CELL || gridType(grid, crocodileCell) != CROCODILE) return;
 
     // Calculate distance to player
-    int dx = abs(crocodileNode->x - player->position->x);
-    int dy = abs(crocodileNode->y - player->position->y);
+    int dx = abs(cellRow(grid, crocodileCell) - cellRow(grid, player->position));
+    int dy = abs(cellCol(grid, crocodileCell) - cellCol(grid, player->position));
 
     // Attack if player is adjacent
     if (dx <= 1 && dy <= 1) {
-        int damage = config->crocodileDamage;
+        int damage = game->config.crocodileDamage;
         player->health -= damage;
+        player->lastDamage = DAMAGE_CROCODILE;
         strcpy(player->message, " Un crocodile vous a attaque !");
 
         if (player->health <= 0) {
@@ -612,463 +523,1130 @@ void checkCrocodileAttack(Node* crocodileNode, Player* player) {
         }
     }
 }
-void cleanupCrocodiles() {
+void cleanupCrocodiles(GameState* game) {
     for (int i = 0; i < MAX_CROCODILES; i++) {
-        while (crocodiles[i].movementQueue.front != NULL) {
-            dequeue(&crocodiles[i].movementQueue);
-        }
+        initQueue(&game->crocodiles[i].movementQueue);
     }
 }
 
 
 
-void initGraphFromMap(Node* graph[ROWS][COLS], Player *player, const char* map) {
-    int row = 0, col = 0;
+int cellIndex(const Grid* grid, int row, int col) {
+    if (row < 0 || row >= grid->rows || col < 0 || col >= grid->cols) return NO_CELL;
+    return row * grid->cols + col;
+}
 
-    // Initialize the graph with safe land
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
-            graph[i][j] = createNode(i, j, SAFE_LAND);
-        }
+int cellRow(const Grid* grid, int cell) {
+    return cell / grid->cols;
+}
+
+int cellCol(const Grid* grid, int cell) {
+    return cell % grid->cols;
+}
+
+// Neighbour of a cell in a z/s/q/d direction, or NO_CELL past the edge
+int cellNeighbor(const Grid* grid, int cell, char direction) {
+    switch (direction) {
+        case 'z': return (cell >= grid->cols) ? cell - grid->cols : NO_CELL;
+        case 's': return (cell + grid->cols < grid->cellCount) ? cell + grid->cols : NO_CELL;
+        case 'q': return (cell % grid->cols != 0) ? cell - 1 : NO_CELL;
+        case 'd': return (cell % grid->cols != grid->cols - 1) ? cell + 1 : NO_CELL;
+        default: return NO_CELL;
     }
+}
 
-    // Parse the map string
-    for (int i = 0; map[i] != '\0'; i++) {
-        if (map[i] == '\n') {
-            row++;
-            col = 0;
-            continue;
-        }
+// Directory bytes, rounded so the chunks that follow stay aligned
+static size_t gridDirectoryBytes(const Grid* grid) {
+    size_t bytes = (size_t)grid->chunkRows * grid->chunkCols * sizeof(int);
+    return (bytes + 63) & ~(size_t)63;
+}
 
-        // Set the type of the current cell based on the map character
-        switch (map[i]) {
-            case '+': graph[row][col]->type = WALL; break;
-            case '#': graph[row][col]->type = THORNS; break;
-            case 'P':
-                graph[row][col]->type = SAFE_LAND;
-                player->position = graph[row][col]; // Set player position
-                break;
-            case 'G': graph[row][col]->type = GUN; break;
-            case 'A': graph[row][col]->type = AXE; break;
-            case 'H': graph[row][col]->type = HEALTH_PACK; break;
-            case 'F': graph[row][col]->type = FOOD; break;
-            case 'O': graph[row][col]->type = PORTAL; break;
-            case 'B': graph[row][col]->type = BOSS; break;
-            case 'C': graph[row][col]->type = CHECKPOINT; break;
-            default: graph[row][col]->type = SAFE_LAND; break;
-        }
-        col++;
+// Make room for `capacity` chunks, keeping the directory and existing chunks
+static void gridReserveChunks(Grid* grid, int capacity) {
+    size_t needed = gridDirectoryBytes(grid) + (size_t)capacity * sizeof(GridChunk);
+    if (needed > grid->blockSize) {
+        grid->block = (char*)realloc(grid->block, needed);
+        grid->blockSize = needed;
     }
+    grid->chunkCapacity = capacity;
+    grid->chunkIndex = (int*)grid->block;
+    grid->chunks = (GridChunk*)(grid->block + gridDirectoryBytes(grid));
+}
 
+static void gridFillChunkRays(Grid* grid, int chunk);
 
-    // Link nodes to their neighbors
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
-            if (i > 0) graph[i][j]->up = graph[i - 1][j];
-            if (i < ROWS - 1) graph[i][j]->down = graph[i + 1][j];
-            if (j > 0) graph[i][j]->left = graph[i][j - 1];
-            if (j < COLS - 1) graph[i][j]->right = graph[i][j + 1];
-        }
+// Give an empty chunk storage, filled with safe land
+static GridChunk* gridMaterializeChunk(Grid* grid, int chunk) {
+    if (grid->chunkCount == grid->chunkCapacity) {
+        gridReserveChunks(grid, grid->chunkCapacity > 0 ? grid->chunkCapacity * 2 : 4);
     }
+    int slot = grid->chunkCount++;
+    memset(grid->chunks[slot].types, SAFE_LAND, sizeof(grid->chunks[slot].types));
+    memset(grid->chunks[slot].health, 0, sizeof(grid->chunks[slot].health));
+    memset(grid->chunks[slot].threats, 0, sizeof(grid->chunks[slot].threats));
+    memset(grid->chunks[slot].threatRows, 0, sizeof(grid->chunks[slot].threatRows));
+    memset(grid->chunks[slot].threatCols, 0, sizeof(grid->chunks[slot].threatCols));
+    memset(grid->chunks[slot].layers, 0, sizeof(grid->chunks[slot].layers));
+    grid->chunkIndex[chunk] = slot;
+    if (grid->raysReady) gridFillChunkRays(grid, chunk);
+    return &grid->chunks[slot];
+}
 
+// Chunk number and offset inside it for a row/column pair
+static inline int chunkOf(const Grid* grid, int row, int col) {
+    return (row >> CHUNK_SHIFT) * grid->chunkCols + (col >> CHUNK_SHIFT);
+}
 
+static inline int chunkOffset(int row, int col) {
+    return ((row & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) | (col & (CHUNK_SIZE - 1));
+}
 
+CellType gridTypeAt(const Grid* grid, int row, int col) {
+    int slot = grid->chunkIndex[chunkOf(grid, row, col)];
+    if (slot == EMPTY_CHUNK) return SAFE_LAND;
+    return (CellType)grid->chunks[slot].types[chunkOffset(row, col)];
 }
-void displayGraph(Node* graph[ROWS][COLS], Player *player) {
-    system(CLEAR);
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
-           if (graph[i][j] == player->position) {
-            printf(BOLD GREEN "P " RESET); // Joueur en gras et vert
 
-        }
-        else{
-        switch (graph[i][j]->type) {
-            case CROCODILE:
-                printf(RED "C " RESET); // Crocodile en rouge
-                break;
-            case SNAKE:
-                printf(YELLOW "S " RESET); // Serpent en jaune
-                break;
-            case THORNS:
-                printf("# ");
-                break;
-            case FOOD:
-                printf(GREEN "F " RESET); // Nourriture en vert
-                break;
-            case GUN:
-                printf(BLUE "G " RESET); // Arme en bleu
-                break;
-            case WALL:
-                printf(BLUE "W " RESET); // Walls in blue
-                break;
-            case AXE:
-                printf(MAGENTA "^ " RESET); // Axe in magenta
-                break;
-            case BULLET:
-                printf(CYAN "* " RESET); // Balle en cyan
-                break;
-            case HEALTH_PACK:
-                printf(WHITE "H " RESET); // Pack de santé en blanc
-                break;
-            case PORTAL:
-                printf(BOLD CYAN "O " RESET); // Portal in cyan
-                break;
-            case BOSS:
-                printf(BOLD RED "B " RESET);  // Boss in bold red
-                break;
-            case CHECKPOINT:
-                printf(BOLD GREEN "C " RESET); // Checkpoint in bold green
-                break;
-            default:
-                printf(". "); // Terrain normal
-                break;
-        }
-    }
-    }
-    printf("\n");
+CellType gridType(const Grid* grid, int cell) {
+    return gridTypeAt(grid, cell / grid->cols, cell % grid->cols);
 }
 
-    printf("Score: %d | PV: %d\n", player->score, player->health);
-    printf("%s\n", player->message); // Afficher le message
-    if(dangerWarning(player,graph)) printf( " Danger detecte a proximite !\n");
+static int isEnemy(CellType type) {
+    return type == CROCODILE || type == SNAKE;
 }
-void cleanupGraph(Node* graph[ROWS][COLS]) {
-    // Iterate through all nodes in the graph
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
-            if (graph[i][j] != NULL) {
-                // Free each node
-                free(graph[i][j]);
-                graph[i][j] = NULL;
-            }
+
+#define LAYER_BIT(layer) (1u << (layer))
+
+// Layers every CellType belongs to, indexed by CellType
+static const unsigned char cellLayers[] = {
+    0,                                                  // SAFE_LAND
+    LAYER_BIT(LAYER_THORNS) | LAYER_BIT(LAYER_OCCUPIED),  // THORNS
+    LAYER_BIT(LAYER_WALL) | LAYER_BIT(LAYER_OCCUPIED),    // WALL
+    LAYER_BIT(LAYER_ENEMY) | LAYER_BIT(LAYER_OCCUPIED),   // CROCODILE
+    LAYER_BIT(LAYER_ENEMY) | LAYER_BIT(LAYER_OCCUPIED),   // SNAKE
+    LAYER_BIT(LAYER_PICKUP) | LAYER_BIT(LAYER_OCCUPIED),  // FOOD
+    LAYER_BIT(LAYER_PICKUP) | LAYER_BIT(LAYER_OCCUPIED),  // GUN
+    LAYER_BIT(LAYER_OCCUPIED),                            // BULLET
+    LAYER_BIT(LAYER_PICKUP) | LAYER_BIT(LAYER_OCCUPIED),  // AXE
+    LAYER_BIT(LAYER_PICKUP) | LAYER_BIT(LAYER_OCCUPIED),  // HEALTH_PACK
+    LAYER_BIT(LAYER_OCCUPIED),                            // PORTAL
+    LAYER_BIT(LAYER_ENEMY) | LAYER_BIT(LAYER_OCCUPIED),   // BOSS
+    LAYER_BIT(LAYER_OCCUPIED)                             // CHECKPOINT
+};
+
+// Bits of the columns from..to (both included) of one chunk row
+static inline unsigned spanMask(int from, int to) {
+    return ((2u << to) - 1) & ~((1u << from) - 1);
+}
+
+// Add (sign 1) or remove (sign -1) an enemy at row/col from the threat data
+// of every cell within THREAT_RADIUS of it
+static void gridAddThreat(Grid* grid, int row, int col, int sign) {
+    int top = row - THREAT_RADIUS > 0 ? row - THREAT_RADIUS : 0;
+    int bottom = row + THREAT_RADIUS < grid->rows - 1 ? row + THREAT_RADIUS : grid->rows - 1;
+    int left = col - THREAT_RADIUS > 0 ? col - THREAT_RADIUS : 0;
+    int right = col + THREAT_RADIUS < grid->cols - 1 ? col + THREAT_RADIUS : grid->cols - 1;
+
+    for (int i = top; i <= bottom; i++) {
+        for (int j = left; j <= right; j++) {
+            int chunk = chunkOf(grid, i, j);
+            if (grid->chunkIndex[chunk] == EMPTY_CHUNK) gridMaterializeChunk(grid, chunk);
+
+            GridChunk* target = &grid->chunks[grid->chunkIndex[chunk]];
+            int offset = chunkOffset(i, j);
+            target->threats[offset] += sign;
+            target->threatRows[offset] += sign * (row - i);
+            target->threatCols[offset] += sign * (col - j);
         }
     }
 }
 
-void initSnakes() {
-    for (int i = 0; i < MAX_SNAKES; i++) {
-        snakes[i].position = NULL;
-        snakes[i].health = 3;
-        snakes[i].shootCooldown = 0;
-    }
+// Row and column step of every ray direction
+static const int rayDeltas[RAY_DIRECTIONS][2] = {
+    {-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {-1, 1}, {1, -1}, {1, 1}
+};
+
+// Ray direction of a row/column step, or -1 when there is no step
+int rayDirection(int dRow, int dCol) {
+    static const signed char directions[9] = {4, 0, 5, 2, -1, 3, 6, 1, 7};
+    return directions[(dRow + 1) * 3 + (dCol + 1)];
 }
 
-void setupSnakes(Node* graph[ROWS][COLS], GameConfig* config) {
-    activeSnakes = config->snakeCount;
+// Free run counted cell by cell, for cells without a stored one
+static int rayWalk(const Grid* grid, int row, int col, int direction) {
+    int run = 0;
+    while (run < RAY_LIMIT) {
+        row += rayDeltas[direction][0];
+        col += rayDeltas[direction][1];
+        if (row < 0 || row >= grid->rows || col < 0 || col >= grid->cols) break;
+        if (gridTypeAt(grid, row, col) != SAFE_LAND) break;
+        run++;
+    }
+    return run;
+}
 
-    // Initialize all snakes
-    initSnakes();
+// Number of safe-land cells in a row after a cell in a ray direction, at
+// most RAY_LIMIT. Cells of allocated chunks have it stored.
+int rayLength(const Grid* grid, int cell, int direction) {
+    int row = cell / grid->cols, col = cell % grid->cols;
+    int slot = grid->chunkIndex[chunkOf(grid, row, col)];
+    if (slot == EMPTY_CHUNK || !grid->raysReady) return rayWalk(grid, row, col, direction);
+    return grid->chunks[slot].rays[direction][chunkOffset(row, col)];
+}
 
-    // Define spawn points
-    struct SpawnPoint {
-        int x, y;
-    };
-    struct SpawnPoint spawnPoints[2];
+static void gridFillChunkRays(Grid* grid, int chunk) {
+    GridChunk* target = &grid->chunks[grid->chunkIndex[chunk]];
+    int top = (chunk / grid->chunkCols) << CHUNK_SHIFT;
+    int left = (chunk % grid->chunkCols) << CHUNK_SHIFT;
 
-    if (config->mapSize == 1) {
-    struct SpawnPoint temp[] = {
-        {8, 4},  // First snake
-        {15, 14}    // Second snake (hard mode only)
-    };
-    // Copy values into spawnPoints
-    for (int i = 0; i < 2; i++) {
-        spawnPoints[i] = temp[i];
-    }
-    } else {
-    struct SpawnPoint temp[] = {
-        {8, 4},  // First snake (example for different map size)
-        {8, 10}    // Second snake (hard mode only)
-    };
-    // Copy values into spawnPoints
-    for (int i = 0; i < 2; i++) {
-        spawnPoints[i] = temp[i];
+    for (int i = 0; i < CHUNK_SIZE && top + i < grid->rows; i++) {
+        for (int j = 0; j < CHUNK_SIZE && left + j < grid->cols; j++) {
+            for (int d = 0; d < RAY_DIRECTIONS; d++) {
+                target->rays[d][chunkOffset(i, j)] = (unsigned char)rayWalk(grid, top + i, left + j, d);
+            }
+        }
     }
 }
-    // Spawn snakes at predetermined points
-    for(int i = 0; i < activeSnakes; i++) {
-        if (graph[spawnPoints[i].x][spawnPoints[i].y]->type == SAFE_LAND) {
-            graph[spawnPoints[i].x][spawnPoints[i].y]->type = SNAKE;
-            graph[spawnPoints[i].x][spawnPoints[i].y]->health = config->snakeHealth;
-            snakes[i].position = graph[spawnPoints[i].x][spawnPoints[i].y];
+
+// A cell became blocked or free: only the cells behind it in each direction,
+// up to the next blocked one and at most RAY_LIMIT away, see their run change
+static void gridUpdateRays(Grid* grid, int row, int col, int blocked) {
+    for (int d = 0; d < RAY_DIRECTIONS; d++) {
+        int ahead = blocked ? 0 : 1 + rayLength(grid, row * grid->cols + col, d);
+        int r = row, c = col;
+
+        for (int k = 1; k <= RAY_LIMIT; k++) {
+            r -= rayDeltas[d][0];
+            c -= rayDeltas[d][1];
+            if (r < 0 || r >= grid->rows || c < 0 || c >= grid->cols) break;
+
+            int run = k - 1 + ahead;
+            int slot = grid->chunkIndex[chunkOf(grid, r, c)];
+            if (slot != EMPTY_CHUNK) {
+                grid->chunks[slot].rays[d][chunkOffset(r, c)] = (unsigned char)(run < RAY_LIMIT ? run : RAY_LIMIT);
+            }
+            if (gridTypeAt(grid, r, c) != SAFE_LAND) break;
         }
     }
 }
 
-// Modified snake shooting function to work with multiple snakes
-void snakeShoot(Node* graph[ROWS][COLS], Player* player, Snake* snake) {
-    if (!snake->position || snake->position->type != SNAKE) return;
-
-    int directions[4][2] = {{-1,0}, {1,0}, {0,-1}, {0,1}}; // up, down, left, right
-    int playerDx = player->position->x - snake->position->x;
-    int playerDy = player->position->y - snake->position->y;
-    int chosenDir = 0;
+static void journalRecord(RewindJournal* journal, JournalKind kind, int where, int value);
 
-    // Choose direction closest to player
-    if (abs(playerDx) > abs(playerDy)) {
-        chosenDir = playerDx > 0 ? 1 : 0;  // down : up
-    } else {
-        chosenDir = playerDy > 0 ? 3 : 2;  // right : left
+void gridSetType(Grid* grid, int cell, CellType type) {
+    int row = cell / grid->cols, col = cell % grid->cols;
+    int chunk = chunkOf(grid, row, col);
+    if (grid->chunkIndex[chunk] == EMPTY_CHUNK) {
+        if (type == SAFE_LAND) return;  // Already safe land
+        gridMaterializeChunk(grid, chunk);
+    }
+    unsigned char* slot = &grid->chunks[grid->chunkIndex[chunk]].types[chunkOffset(row, col)];
+    CellType previous = (CellType)*slot;
+    if (grid->journal != NULL && previous != type) journalRecord(grid->journal, JOURNAL_CELL_TYPE, cell, previous);
+    if (isWalkable(previous) != isWalkable(type)) grid->terrainVersion++;
+    *slot = (unsigned char)type;
+
+    // Flip the cell's bit in the layers it joins or leaves
+    unsigned changed = cellLayers[previous] ^ cellLayers[type];
+    unsigned short* rows = &grid->chunks[grid->chunkIndex[chunk]].layers[0][row & (CHUNK_SIZE - 1)];
+    if (grid->raysReady && (changed & LAYER_BIT(LAYER_OCCUPIED))) gridUpdateRays(grid, row, col, type != SAFE_LAND);
+    for (int layer = 0; changed != 0; layer++, changed >>= 1) {
+        if (changed & 1) rows[layer * CHUNK_SIZE] ^= (unsigned short)(1u << (col & (CHUNK_SIZE - 1)));
     }
 
-    Node* bulletPos = snake->position;
-    int dx = directions[chosenDir][0];
-    int dy = directions[chosenDir][1];
+    // Enemies spawning, moving and dying all come through here
+    if (isEnemy(previous) != isEnemy(type)) gridAddThreat(grid, row, col, isEnemy(type) ? 1 : -1);
+}
 
-    while (1) {
-        int newX = bulletPos->x + dx;
-        int newY = bulletPos->y + dy;
+// Number of enemies within THREAT_RADIUS of a cell
+int threatCount(const Grid* grid, int cell) {
+    int row = cell / grid->cols, col = cell % grid->cols;
+    int slot = grid->chunkIndex[chunkOf(grid, row, col)];
+    if (slot == EMPTY_CHUNK) return 0;
+    return grid->chunks[slot].threats[chunkOffset(row, col)];
+}
 
-        if (newX < 0 || newX >= ROWS || newY < 0 || newY >= COLS) break;
+// Summed row and column offsets from a cell to the enemies near it; their
+// signs give the general direction the danger comes from
+void threatDirection(const Grid* grid, int cell, int* dRow, int* dCol) {
+    int row = cell / grid->cols, col = cell % grid->cols;
+    int slot = grid->chunkIndex[chunkOf(grid, row, col)];
+    *dRow = *dCol = 0;
+    if (slot == EMPTY_CHUNK) return;
+    *dRow = grid->chunks[slot].threatRows[chunkOffset(row, col)];
+    *dCol = grid->chunks[slot].threatCols[chunkOffset(row, col)];
+}
 
-        if (graph[newX][newY] == player->position) {
-             int damage = config->snakeDamage;
-            player->health -= damage;
-            strcpy(player->message, " Touch par un serpent !");
-            break;
+int gridHasLayer(const Grid* grid, int cell, CellLayer layer) {
+    int row = cell / grid->cols, col = cell % grid->cols;
+    int slot = grid->chunkIndex[chunkOf(grid, row, col)];
+    if (slot == EMPTY_CHUNK) return 0;  // Safe land is in no layer
+    return (grid->chunks[slot].layers[layer][row & (CHUNK_SIZE - 1)] >> (col & (CHUNK_SIZE - 1))) & 1;
+}
+
+// Whether a cell of the layer lies within `radius` rows and columns of a cell.
+// Each chunk row in the window is tested 16 cells at a time.
+int gridAnyWithin(const Grid* grid, int cell, int radius, CellLayer layer) {
+    int row = cell / grid->cols, col = cell % grid->cols;
+    int top = row - radius > 0 ? row - radius : 0;
+    int bottom = row + radius < grid->rows - 1 ? row + radius : grid->rows - 1;
+    int left = col - radius > 0 ? col - radius : 0;
+    int right = col + radius < grid->cols - 1 ? col + radius : grid->cols - 1;
+
+    for (int chunkCol = left >> CHUNK_SHIFT; chunkCol <= right >> CHUNK_SHIFT; chunkCol++) {
+        int first = chunkCol << CHUNK_SHIFT;
+        unsigned mask = spanMask(left > first ? left - first : 0,
+                                 right < first + CHUNK_SIZE - 1 ? right - first : CHUNK_SIZE - 1);
+        for (int i = top; i <= bottom; i++) {
+            int slot = grid->chunkIndex[(i >> CHUNK_SHIFT) * grid->chunkCols + chunkCol];
+            if (slot == EMPTY_CHUNK) {
+                i |= CHUNK_SIZE - 1;  // Nothing in the rest of this chunk
+                continue;
+            }
+            if (grid->chunks[slot].layers[layer][i & (CHUNK_SIZE - 1)] & mask) return 1;
         }
+    }
+    return 0;
+}
 
-        if (graph[newX][newY]->type != SAFE_LAND) break;
+int gridHealth(const Grid* grid, int cell) {
+    int row = cell / grid->cols, col = cell % grid->cols;
+    int slot = grid->chunkIndex[chunkOf(grid, row, col)];
+    if (slot == EMPTY_CHUNK) return 0;
+    return grid->chunks[slot].health[chunkOffset(row, col)];
+}
 
-        bulletPos = graph[newX][newY];
-        bulletPos->type = BULLET;
-        displayGraph(graph, player);
-        usleep(50000);
-        bulletPos->type = SAFE_LAND;
+void gridSetHealth(Grid* grid, int cell, int health) {
+    int row = cell / grid->cols, col = cell % grid->cols;
+    int chunk = chunkOf(grid, row, col);
+    if (grid->chunkIndex[chunk] == EMPTY_CHUNK) {
+        if (health == 0) return;
+        gridMaterializeChunk(grid, chunk);
     }
+    short* slot = &grid->chunks[grid->chunkIndex[chunk]].health[chunkOffset(row, col)];
+    if (grid->journal != NULL && *slot != health) journalRecord(grid->journal, JOURNAL_CELL_HEALTH, cell, *slot);
+    *slot = (short)health;
 }
 
-void handleAllSnakesShooting(Node* graph[ROWS][COLS], Player* player) {
-    for (int i = 0; i < activeSnakes; i++) {
-        if (!snakes[i].position || snakes[i].position->type != SNAKE) continue;
-
-        if (snakes[i].shootCooldown++ >= 3) {  // Shoot every 3 turns
-            snakeShoot(graph, player, &snakes[i]);
-            snakes[i].shootCooldown = 0;
+// Size of a map string: number of lines and length of the longest one.
+// Returns 0 if the map is empty or larger than MAX_MAP_SIZE either way.
+int measureMap(const char* map, int* rows, int* cols) {
+    int row = 0, col = 0;
+    *rows = 0;
+    *cols = 0;
+    for (int i = 0; map[i] != '\0'; i++) {
+        if (map[i] == '\n') {
+            row++;
+            col = 0;
+            continue;
         }
+        col++;
+        if (col > *cols) *cols = col;
+        *rows = row + 1;
     }
+    return *rows > 0 && *rows <= MAX_MAP_SIZE && *cols <= MAX_MAP_SIZE;
 }
 
-void cleanupSnakes() {
-    for (int i = 0; i < MAX_SNAKES; i++) {
-        snakes[i].position = NULL;
+// Read a map from a text file, using the same characters as the built-in maps
+char* loadMapFile(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* map = (char*)malloc(size + 1);
+    size_t length = fread(map, 1, size, file);
+    map[length] = '\0';
+    fclose(file);
+
+    int rows, cols;
+    if (!measureMap(map, &rows, &cols)) {
+        free(map);
+        return NULL;
     }
+    return map;
 }
-const char* bossMap =
-        "+++++++++++++++\n"
-        "+ P   A     G +\n"
-        "+          #  +\n"
-        "+    ++       +\n"
-        "+  ##     B   +\n"
-        "+           H +\n"
-        "+  ##       # +\n"
-        "+G   F    # G +\n"
-        "+++++++++++++++\n";
 
+// Row and column step of a z/s/q/d direction
+void directionDelta(char direction, int* dRow, int* dCol) {
+    *dRow = (direction == 's') - (direction == 'z');
+    *dCol = (direction == 'd') - (direction == 'q');
+}
 
-void initializeBoss(Node* graph[ROWS][COLS], Player* player, const char* bossMap) {
-    // Reset the graph for boss arena
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
-            if (graph[i][j] != NULL) {
-                free(graph[i][j]);
-                graph[i][j] = NULL;
+// Parse a map string into the grid, reusing its storage
+static void parseMap(Grid* grid, const char* map) {
+    int row = 0, col = 0;
+    int rows, cols;
+
+    measureMap(map, &rows, &cols);
+    if (rows > MAX_MAP_SIZE) rows = MAX_MAP_SIZE;
+    if (cols > MAX_MAP_SIZE) cols = MAX_MAP_SIZE;
+
+    grid->rows = rows;
+    grid->cols = cols;
+    grid->cellCount = rows * cols;
+    grid->chunkRows = (rows + CHUNK_SIZE - 1) >> CHUNK_SHIFT;
+    grid->chunkCols = (cols + CHUNK_SIZE - 1) >> CHUNK_SHIFT;
+    grid->spawns.player = NO_CELL;
+    grid->spawns.boss = NO_CELL;
+    grid->spawns.crocodileCount = 0;
+    grid->spawns.snakeCount = 0;
+    grid->terrainVersion++;  // Anything derived from the previous map is stale
+    grid->raysReady = 0;     // Built in one go once every cell is known
+
+    // Count the chunks that hold anything but safe land, so the block is
+    // sized once; the storage is kept across restarts and arenas. The
+    // directory doubles as the "chunk used" flags while counting.
+    int needed = 0;
+    int* used;
+    grid->chunkCount = 0;
+    gridReserveChunks(grid, grid->chunkCapacity);
+    used = grid->chunkIndex;
+    memset(used, 0, grid->chunkRows * grid->chunkCols * sizeof(int));
+    for (int i = 0; map[i] != '\0'; i++) {
+        if (map[i] == '\n') {
+            row++;
+            col = 0;
+            continue;
+        }
+        if (row < rows && col < cols && map[i] != ' ' && map[i] != 'P' && map[i] != 'c' && map[i] != 's') {
+            int chunk = chunkOf(grid, row, col);
+            if (!used[chunk]) {
+                used[chunk] = 1;
+                needed++;
             }
         }
+        col++;
     }
 
-    // Initialize new map
-    initGraphFromMap(graph, player, bossMap);
-
-    // Initialize boss
+    // Initialize the grid with safe land
+    if (needed > grid->chunkCapacity) gridReserveChunks(grid, needed);
+    for (int i = 0; i < grid->chunkRows * grid->chunkCols; i++) {
+        grid->chunkIndex[i] = EMPTY_CHUNK;
+    }
 
-    boss.health = 100;
-    boss.attackCooldown = 0;
-    boss.moveCooldown = 0;
-    boss.phaseNumber = 1;
-    boss.isActive = 1;
+    // Parse the map string
+    row = 0;
+    col = 0;
+    for (int i = 0; map[i] != '\0'; i++) {
+        if (map[i] == '\n') {
+            row++;
+            col = 0;
+            continue;
+        }
 
+        int cell = cellIndex(grid, row, col);
+        col++;
+        if (cell == NO_CELL) continue;  // Beyond MAX_MAP_SIZE
 
-    // Find boss starting position (marked as 'B' in the map)
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
-            if (graph[i][j]->type == BOSS) {
-                boss.position = graph[i][j];
+        // Set the type of the current cell based on the map character
+        switch (map[i]) {
+            case '+': gridSetType(grid, cell, WALL); break;
+            case '#': gridSetType(grid, cell, THORNS); break;
+            case 'P': grid->spawns.player = cell; break;
+            case 'G': gridSetType(grid, cell, GUN); break;
+            case 'A': gridSetType(grid, cell, AXE); break;
+            case 'H': gridSetType(grid, cell, HEALTH_PACK); break;
+            case 'F': gridSetType(grid, cell, FOOD); break;
+            case 'O': gridSetType(grid, cell, PORTAL); break;
+            case 'B':
+                gridSetType(grid, cell, BOSS);
+                grid->spawns.boss = cell;
                 break;
-            }
+            case 'C': gridSetType(grid, cell, CHECKPOINT); break;
+            case 'c':   // Crocodile spawn point, safe land otherwise
+                if (grid->spawns.crocodileCount < MAX_CROCODILES)
+                    grid->spawns.crocodiles[grid->spawns.crocodileCount++] = cell;
+                break;
+            case 's':   // Snake spawn point, safe land otherwise
+                if (grid->spawns.snakeCount < MAX_SNAKES)
+                    grid->spawns.snakes[grid->spawns.snakeCount++] = cell;
+                break;
+            default: break;  // Safe land
         }
     }
-    if (boss.position == NULL) {
-        printf("Error: Boss position not found!\n");
-        exit(1);
+
+    for (int chunk = 0; chunk < grid->chunkRows * grid->chunkCols; chunk++) {
+        if (grid->chunkIndex[chunk] != EMPTY_CHUNK) gridFillChunkRays(grid, chunk);
     }
+    grid->raysReady = 1;
 }
-void shootAtPlayer(Node* graph[ROWS][COLS], Player* player) {
-    int dx = player->position->x - boss.position->x;
-    int dy = player->position->y - boss.position->y;
 
-    // Normalize direction
-    int dirX = (dx != 0) ? dx / abs(dx) : 0;
-    int dirY = (dy != 0) ? dy / abs(dy) : 0;
+static MapTemplate mapTemplates[3];
+#define MAP_TEMPLATE_COUNT (int)(sizeof(mapTemplates) / sizeof(mapTemplates[0]))
 
-    Node* bulletPos = boss.position;
-    while (1) {
-        int newX = bulletPos->x + dirX;
-        int newY = bulletPos->y + dirY;
+static void buildMapTemplates(void) {
+    const char* maps[MAP_TEMPLATE_COUNT] = {smallMap, bigMap, bossMap};
+    for (int i = 0; i < MAP_TEMPLATE_COUNT; i++) {
+        mapTemplates[i].map = maps[i];
+        parseMap(&mapTemplates[i].grid, maps[i]);
+    }
+}
 
-        if (newX < 0 || newX >= ROWS || newY < 0 || newY >= COLS) break;
+// The templates are built by whichever session starts first, once
+#ifdef _WIN32
+static INIT_ONCE mapTemplatesOnce = INIT_ONCE_STATIC_INIT;
 
-        if (graph[newX][newY] == player->position) {
-            player->health -= 10;
-            strcpy(player->message, " Le boss vous a touche avec son attaque a distance !");
-            break;
+static BOOL CALLBACK buildMapTemplatesOnce(PINIT_ONCE once, PVOID parameter, PVOID* context) {
+    (void)once; (void)parameter; (void)context;
+    buildMapTemplates();
+    return TRUE;
+}
+#else
+static pthread_once_t mapTemplatesOnce = PTHREAD_ONCE_INIT;
+#endif
+
+// Parsed copy of a built-in map, or NULL for any other map
+static const Grid* findMapTemplate(const char* map) {
+#ifdef _WIN32
+    InitOnceExecuteOnce(&mapTemplatesOnce, buildMapTemplatesOnce, NULL, NULL);
+#else
+    pthread_once(&mapTemplatesOnce, buildMapTemplates);
+#endif
+    for (int i = 0; i < MAP_TEMPLATE_COUNT; i++) {
+        if (mapTemplates[i].map == map) return &mapTemplates[i].grid;
+    }
+    return NULL;
+}
+
+// Make the grid a copy of a template: its directory and chunks are laid out
+// the same way, so they come over in a single block copy
+static void gridCopyTemplate(Grid* grid, const Grid* source) {
+    grid->rows = source->rows;
+    grid->cols = source->cols;
+    grid->cellCount = source->cellCount;
+    grid->chunkRows = source->chunkRows;
+    grid->chunkCols = source->chunkCols;
+    grid->spawns = source->spawns;
+    grid->raysReady = source->raysReady;
+    grid->terrainVersion++;  // Anything derived from the previous map is stale
+
+    grid->chunkCount = 0;
+    gridReserveChunks(grid, source->chunkCount > grid->chunkCapacity ? source->chunkCount : grid->chunkCapacity);
+    memcpy(grid->block, source->block, gridDirectoryBytes(source) + (size_t)source->chunkCount * sizeof(GridChunk));
+    grid->chunkCount = source->chunkCount;
+}
+
+// Load a map into the grid and put the player on its start cell. Built-in
+// maps are copied from their template; any other map is parsed.
+void initGraphFromMap(Grid* grid, Player *player, const char* map) {
+    const Grid* source = findMapTemplate(map);
+    if (source != NULL) gridCopyTemplate(grid, source);
+    else parseMap(grid, map);
+    if (grid->journal != NULL) clearRewindJournal(grid->journal);  // No rewinding across a map change
+    if (grid->spawns.player != NO_CELL) player->position = grid->spawns.player;
+}
+
+// SGR sequence for every CellStyle, each one resets the previous colour first
+static const char* styleCodes[] = {
+    "\x1b[0m",
+    "\x1b[0;31m",
+    "\x1b[0;33m",
+    "\x1b[0;32m",
+    "\x1b[0;34m",
+    "\x1b[0;35m",
+    "\x1b[0;36m",
+    "\x1b[0;37m",
+    "\x1b[0;1;32m",
+    "\x1b[0;1;36m",
+    "\x1b[0;1;31m"
+};
+
+// How each CellType is drawn, indexed by CellType
+static const ScreenCell cellAppearance[] = {
+    {'.', STYLE_PLAIN},        // SAFE_LAND: terrain normal
+    {'#', STYLE_PLAIN},        // THORNS
+    {'W', STYLE_BLUE},         // WALL
+    {'C', STYLE_RED},          // CROCODILE
+    {'S', STYLE_YELLOW},       // SNAKE
+    {'F', STYLE_GREEN},        // FOOD
+    {'G', STYLE_BLUE},         // GUN
+    {'*', STYLE_CYAN},         // BULLET
+    {'^', STYLE_MAGENTA},      // AXE
+    {'H', STYLE_WHITE},        // HEALTH_PACK
+    {'O', STYLE_BOLD_CYAN},    // PORTAL
+    {'B', STYLE_BOLD_RED},     // BOSS
+    {'C', STYLE_BOLD_GREEN}    // CHECKPOINT
+};
+
+// Inventory names, indexed by ItemKind
+static const char* itemNames[ITEM_KIND_COUNT] = {
+    [ITEM_BULLETS] = "Bullets",
+    [ITEM_AXE] = "Axe",
+    [ITEM_FOOD] = "Food",
+    [ITEM_HEALTH_PACK] = "Health Pack"
+};
+
+static void rendererAppend(Renderer* renderer, const char* data, size_t length) {
+    memcpy(renderer->out + renderer->outLength, data, length);
+    renderer->outLength += length;
+}
+
+// Send the pending bytes in one go, retrying on partial writes, or hand them to the sink
+static void rendererWrite(Renderer* renderer, const char* data, size_t length) {
+    if (renderer->sink != NULL) {
+        renderer->sink(renderer->sinkContext, data, length);
+        return;
+    }
+    fflush(stdout);  // Keep anything printed with stdio ahead of the frame
+#ifdef _WIN32
+    fwrite(data, 1, length, stdout);
+    fflush(stdout);
+#else
+    while (length > 0) {
+        ssize_t written = write(renderer->fd, data, length);
+        if (written <= 0) break;
+        data += written;
+        length -= written;
+    }
+#endif
+}
+
+// Switch to the alternate screen and allocate both frame buffers
+void rendererBegin(Renderer* renderer, int fd, int width, int height) {
+    renderer->width = width;
+    renderer->height = height;
+    renderer->fd = fd;
+    renderer->front = (ScreenCell*)malloc(width * height * sizeof(ScreenCell));
+    renderer->back = (ScreenCell*)malloc(width * height * sizeof(ScreenCell));
+    // Worst case per cell: cursor move, colour change and the glyph itself
+    renderer->outCapacity = (size_t)width * height * 24 + 64;
+    renderer->out = (char*)malloc(renderer->outCapacity);
+    renderer->outLength = 0;
+    renderer->prompt[0][0] = renderer->prompt[1][0] = '\0';
+    renderer->active = 1;
+
+    // The screen starts out blank, so front starts out as blanks too
+    for (int i = 0; i < width * height; i++) {
+        renderer->front[i].glyph = ' ';
+        renderer->front[i].style = STYLE_PLAIN;
+    }
+
+    const char enter[] = ALT_SCREEN_ON CURSOR_HIDE CLEAR_SCREEN;
+    rendererWrite(renderer, enter, sizeof(enter) - 1);
+}
+
+// Restore the normal screen and release the frame buffers
+void rendererEnd(Renderer* renderer) {
+    if (!renderer->active) return;
+
+    const char leave[] = RESET CURSOR_SHOW ALT_SCREEN_OFF;
+    rendererWrite(renderer, leave, sizeof(leave) - 1);
+
+    free(renderer->front);
+    free(renderer->back);
+    free(renderer->out);
+    renderer->front = renderer->back = NULL;
+    renderer->out = NULL;
+    renderer->active = 0;
+}
+
+void rendererClear(Renderer* renderer) {
+    for (int i = 0; i < renderer->width * renderer->height; i++) {
+        renderer->back[i].glyph = ' ';
+        renderer->back[i].style = STYLE_PLAIN;
+    }
+}
+
+// Copy text into the back buffer, clipped to the screen width
+void rendererPutText(Renderer* renderer, int row, int col, const char* text, CellStyle style) {
+    if (row < 0 || row >= renderer->height) return;
+
+    ScreenCell* line = renderer->back + row * renderer->width;
+    for (int j = col; text[j - col] != '\0' && j < renderer->width; j++) {
+        line[j].glyph = text[j - col];
+        line[j].style = style;
+    }
+}
+
+// Compare back against front and send only the cells that changed
+void rendererPresent(Renderer* renderer) {
+    int cursorRow = -1, cursorCol = -1;
+    int style = -1;
+    char move[16];
+
+    renderer->outLength = 0;
+    for (int i = 0; i < renderer->height; i++) {
+        for (int j = 0; j < renderer->width; j++) {
+            ScreenCell* cell = &renderer->back[i * renderer->width + j];
+            ScreenCell* shown = &renderer->front[i * renderer->width + j];
+            if (cell->glyph == shown->glyph && cell->style == shown->style) continue;
+
+            if (i != cursorRow || j != cursorCol) {
+                int length = snprintf(move, sizeof(move), "\x1b[%d;%dH", i + 1, j + 1);
+                rendererAppend(renderer, move, length);
+            }
+            if (cell->style != style) {
+                style = cell->style;
+                rendererAppend(renderer, styleCodes[style], strlen(styleCodes[style]));
+            }
+            rendererAppend(renderer, &cell->glyph, 1);
+            *shown = *cell;
+            cursorRow = i;
+            cursorCol = j + 1;
+        }
+    }
+    if (style > STYLE_PLAIN) rendererAppend(renderer, RESET, sizeof(RESET) - 1);
+
+    if (renderer->outLength > 0) rendererWrite(renderer, renderer->out, renderer->outLength);
+}
+
+// Text shown on the last two HUD lines until it is replaced
+void setPrompt(Renderer* renderer, const char* title, const char* question) {
+    snprintf(renderer->prompt[0], sizeof(renderer->prompt[0]), "%s", title);
+    snprintf(renderer->prompt[1], sizeof(renderer->prompt[1]), "%s", question);
+}
+
+// Clear the terminal without spawning a shell
+void clearScreen(void) {
+#ifdef _WIN32
+    system(CLEAR);
+#else
+    fputs(CLEAR_SCREEN, stdout);
+    fflush(stdout);
+#endif
+}
+
+// Size of the terminal, or 24x80 when it cannot be queried
+void terminalSize(int* rows, int* cols) {
+    *rows = 24;
+    *cols = SCREEN_WIDTH;
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+        *rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+        *cols = info.srWindow.Right - info.srWindow.Left + 1;
+    }
+#else
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+        *rows = size.ws_row;
+        *cols = size.ws_col;
+    }
+#endif
+}
+
+// First row or column of a view of `visible` cells centred on `center`
+static int viewOrigin(int center, int visible, int total) {
+    int origin = center - visible / 2;
+    if (origin > total - visible) origin = total - visible;
+    if (origin < 0) origin = 0;
+    return origin;
+}
+
+void displayGraph(Renderer* renderer, GameState* game) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+    char line[SCREEN_WIDTH + 1];
+
+    // Maps larger than the screen are shown through a window that follows the player
+    int viewRows = renderer->height - HUD_LINES;
+    int viewCols = renderer->width / 2;
+    if (viewRows > grid->rows) viewRows = grid->rows;
+    if (viewCols > grid->cols) viewCols = grid->cols;
+    int top = viewOrigin(cellRow(grid, player->position), viewRows, grid->rows);
+    int left = viewOrigin(cellCol(grid, player->position), viewCols, grid->cols);
+
+    rendererClear(renderer);
+    for (int i = 0; i < viewRows; i++) {
+        ScreenCell* row = renderer->back + i * renderer->width;
+        for (int j = 0; j < viewCols; j++) {
+            if (cellIndex(grid, top + i, left + j) == player->position) {
+                row[j * 2].glyph = 'P';  // Joueur en gras et vert
+                row[j * 2].style = STYLE_BOLD_GREEN;
+            } else {
+                row[j * 2] = cellAppearance[gridTypeAt(grid, top + i, left + j)];
+            }
+            row[j * 2 + 1].style = row[j * 2].style;  // Same colour for the spacer avoids a colour switch per cell
+        }
+    }
+
+    // Projectiles are drawn over the cells they fly across
+    for (int i = 0; i < game->projectiles.count; i++) {
+        int row = cellRow(grid, game->projectiles.items[i].cell) - top;
+        int col = cellCol(grid, game->projectiles.items[i].cell) - left;
+        if (row < 0 || row >= viewRows || col < 0 || col >= viewCols) continue;
+        ScreenCell* cell = renderer->back + row * renderer->width + col * 2;
+        cell[0] = cellAppearance[BULLET];  // Balle en cyan
+        cell[1].style = cell[0].style;
+    }
+
+    snprintf(line, sizeof(line), "Score: %d | PV: %d", player->score, player->health);
+    rendererPutText(renderer, viewRows, 0, line, STYLE_PLAIN);
+    rendererPutText(renderer, viewRows + 1, 0, player->message, STYLE_PLAIN);  // Afficher le message
+    int threats = dangerWarning(player, grid);
+    if (threats > 0) {
+        static const char* headings[3][3] = {
+            {"au nord-ouest", "au nord", "au nord-est"},
+            {"a l'ouest", "tout autour", "a l'est"},
+            {"au sud-ouest", "au sud", "au sud-est"}
+        };
+        int dRow, dCol;
+        threatDirection(grid, player->position, &dRow, &dCol);
+        snprintf(line, sizeof(line), " Danger detecte a proximite ! %d ennemi(s) %s", threats,
+                 headings[(dRow > 0) - (dRow < 0) + 1][(dCol > 0) - (dCol < 0) + 1]);
+        rendererPutText(renderer, viewRows + 2, 0, line, STYLE_PLAIN);
+    }
+    if (game->boss.isActive) {
+        snprintf(line, sizeof(line), "HP: %d | Boss HP: %d", player->health, game->boss.health);  // Display player and boss health
+        rendererPutText(renderer, viewRows + 3, 0, line, STYLE_PLAIN);
+    }
+    rendererPutText(renderer, viewRows + 4, 0, "[z] Up, [s] Down, [q] Left, [d] Right, [f] Shoot, [i] Inventory", STYLE_PLAIN);
+    rendererPutText(renderer, viewRows + 5, 0, "[u] Use health pack, [c] Break thorns, [x] Quit, [r] Return to checkpoint", STYLE_PLAIN);
+    rendererPutText(renderer, viewRows + 6, 0, renderer->prompt[0], STYLE_BOLD_CYAN);
+    rendererPutText(renderer, viewRows + 7, 0, renderer->prompt[1], STYLE_PLAIN);
+
+    rendererPresent(renderer);
+}
+
+void cleanupGraph(Grid* grid) {
+    // The directory and every chunk live in one block
+    free(grid->block);
+    grid->block = NULL;
+    grid->blockSize = 0;
+    grid->chunkIndex = NULL;
+    grid->chunks = NULL;
+    grid->chunkCount = grid->chunkCapacity = 0;
+}
+
+void initSnakes(GameState* game) {
+    for (int i = 0; i < MAX_SNAKES; i++) {
+        game->snakes[i].position = NO_CELL;
+        game->snakes[i].health = 3;
+        game->snakes[i].shootCooldown = 0;
+    }
+}
+
+void setupSnakes(GameState* game) {
+    Grid* grid = &game->grid;
+
+    game->activeSnakes = game->config.snakeCount;
+
+    // Initialize all snakes
+    initSnakes(game);
+
+    // Define spawn points
+    struct SpawnPoint {
+        int x, y;
+    };
+    struct SpawnPoint spawnPoints[2];
+    int spawnCells[MAX_SNAKES];
+    int spawnCount = 2;
+
+    if (game->config.mapSize == BIG_MAP) {
+    struct SpawnPoint temp[] = {
+        {8, 4},  // First snake
+        {15, 14}    // Second snake (hard mode only)
+    };
+    // Copy values into spawnPoints
+    for (int i = 0; i < 2; i++) {
+        spawnPoints[i] = temp[i];
+    }
+    } else {
+    struct SpawnPoint temp[] = {
+        {8, 4},  // First snake (example for different map size)
+        {8, 10}    // Second snake (hard mode only)
+    };
+    // Copy values into spawnPoints
+    for (int i = 0; i < 2; i++) {
+        spawnPoints[i] = temp[i];
+    }
+}
+    // Same precedence as for crocodiles: map markers, then the tables
+    if (grid->spawns.snakeCount > 0 || game->config.mapSize == CUSTOM_MAP) {
+        spawnCount = grid->spawns.snakeCount;
+        memcpy(spawnCells, grid->spawns.snakes, sizeof(spawnCells));
+    } else {
+        for (int i = 0; i < spawnCount; i++) {
+            spawnCells[i] = cellIndex(grid, spawnPoints[i].x, spawnPoints[i].y);
+        }
+    }
+
+    // Spawn snakes at predetermined points
+    for(int i = 0; i < game->activeSnakes && i < spawnCount; i++) {
+        int cell = spawnCells[i];
+        if (cell != NO_CELL && gridType(grid, cell) == SAFE_LAND) {
+            gridSetType(grid, cell, SNAKE);
+            gridSetHealth(grid, cell, game->config.snakeHealth);
+            game->snakes[i].position = cell;
         }
+    }
+}
+
+// Modified snake shooting function to work with multiple snakes
+void snakeShoot(GameState* game, Snake* snake) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+
+    if (snake->position == NO_CELL || gridType(grid, snake->position) != SNAKE) return;
+
+    int directions[4][2] = {{-1,0}, {1,0}, {0,-1}, {0,1}}; // up, down, left, right
+    int playerDx = cellRow(grid, player->position) - cellRow(grid, snake->position);
+    int playerDy = cellCol(grid, player->position) - cellCol(grid, snake->position);
+    int chosenDir = 0;
 
-        if (graph[newX][newY]->type != SAFE_LAND) break;
+    // Choose direction closest to player
+    if (abs(playerDx) > abs(playerDy)) {
+        chosenDir = playerDx > 0 ? 1 : 0;  // down : up
+    } else {
+        chosenDir = playerDy > 0 ? 3 : 2;  // right : left
+    }
+
+    spawnProjectile(&game->projectiles, snake->position, directions[chosenDir][0], directions[chosenDir][1],
+                    OWNER_SNAKE, game->config.snakeDamage);
+}
 
-        bulletPos = graph[newX][newY];
-        bulletPos->type = BULLET;
-        displayGraph(graph, player);
-        usleep(50000);
-        bulletPos->type = SAFE_LAND;
+void handleAllSnakesShooting(GameState* game) {
+    for (int i = 0; i < game->activeSnakes; i++) {
+        if (game->snakes[i].position == NO_CELL || gridType(&game->grid, game->snakes[i].position) != SNAKE) continue;
+
+        if (game->snakes[i].shootCooldown++ >= 3) {  // Shoot every 3 turns
+            snakeShoot(game, &game->snakes[i]);
+            game->snakes[i].shootCooldown = 0;
+        }
     }
 }
-void moveBoss(Node* graph[ROWS][COLS], Player* player) {
-    if (!boss.isActive || boss.moveCooldown > 0) {
-        boss.moveCooldown--;
+
+void cleanupSnakes(GameState* game) {
+    for (int i = 0; i < MAX_SNAKES; i++) {
+        game->snakes[i].position = NO_CELL;
+    }
+}
+const char* bossMap =
+        "+++++++++++++++\n"
+        "+ P   A     G +\n"
+        "+          #  +\n"
+        "+    ++       +\n"
+        "+  ##     B   +\n"
+        "+           H +\n"
+        "+  ##       # +\n"
+        "+G   F    # G +\n"
+        "+++++++++++++++\n";
+
+
+// Move the player into the boss arena. Returns 0 if the arena map has no
+// boss: the game then ends as quit, and the front-end decides what to do.
+int initializeBoss(GameState* game, const char* bossMap) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+
+    // The jungle's enemies stay behind: their cells mean nothing in the arena
+    cleanupCrocodiles(game);
+    cleanupSnakes(game);
+    for (int i = 0; i < MAX_CROCODILES; i++) game->crocodiles[i].position = NO_CELL;
+    game->activeCrocodiles = 0;
+    game->activeSnakes = 0;
+
+    // Load the boss arena into the existing grid storage
+    initGraphFromMap(grid, player, bossMap);
+    player->readyForBoss = 0;
+    clearProjectiles(&game->projectiles);  // Bullets from the jungle don't follow the player into the arena
+
+    // Initialize boss
+
+    game->boss.health = 100;
+    game->boss.attackCooldown = 0;
+    game->boss.moveCooldown = 0;
+    game->boss.phaseNumber = 1;
+    game->boss.isActive = 1;
+
+
+    // Boss starting position, found while the map was parsed ('B')
+    game->boss.position = grid->spawns.boss;
+    if (game->boss.position == NO_CELL) {
+        game->boss.isActive = 0;
+        player->hasQuit = 1;
+        strcpy(player->message, " Erreur : pas de boss dans l'arene !");
+        return 0;
+    }
+    return 1;
+}
+void shootAtPlayer(GameState* game) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+    int dx = cellRow(grid, player->position) - cellRow(grid, game->boss.position);
+    int dy = cellCol(grid, player->position) - cellCol(grid, game->boss.position);
+
+    // Normalize direction
+    int dirX = (dx != 0) ? dx / abs(dx) : 0;
+    int dirY = (dy != 0) ? dy / abs(dy) : 0;
+
+    spawnProjectile(&game->projectiles, game->boss.position, dirX, dirY, OWNER_BOSS, 10);
+}
+void moveBoss(GameState* game) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+
+    if (!game->boss.isActive || game->boss.moveCooldown > 0) {
+        game->boss.moveCooldown--;
         return;
     }
 
-    int dx = player->position->x - boss.position->x;
-    int dy = player->position->y - boss.position->y;
+    int dx = cellRow(grid, player->position) - cellRow(grid, game->boss.position);
+    int dy = cellCol(grid, player->position) - cellCol(grid, game->boss.position);
 
     // Determine the direction to move
     int dirX = (dx != 0) ? dx / abs(dx) : 0;
     int dirY = (dy != 0) ? dy / abs(dy) : 0;
 
     // Try to move in the preferred direction
-    int newX = boss.position->x + dirX;
-    int newY = boss.position->y + dirY;
+    int next = cellIndex(grid, cellRow(grid, game->boss.position) + dirX, cellCol(grid, game->boss.position) + dirY);
 
-    if (newX >= 0 && newX < ROWS && newY >= 0 && newY < COLS) {
-        if (graph[newX][newY]->type == SAFE_LAND) {
+    if (next != NO_CELL) {
+        if (!gridHasLayer(grid, next, LAYER_OCCUPIED)) {
             // Move the boss
-            boss.position->type = SAFE_LAND;  // Clear the old position
-            boss.position = graph[newX][newY];
-            boss.position->type = BOSS;  // Mark the new position
+            gridSetType(grid, game->boss.position, SAFE_LAND);  // Clear the old position
+            game->boss.position = next;
+            gridSetType(grid, game->boss.position, BOSS);  // Mark the new position
         }
     }
 
     // Reset the move cooldown
-    boss.moveCooldown = 2;  // Adjust this value to control movement speed
+    game->boss.moveCooldown = 2;  // Adjust this value to control movement speed
 }
 
-void bossAttackPattern(Node* graph[ROWS][COLS], Player* player) {
-    if (!boss.isActive || boss.attackCooldown > 0) {
-        boss.attackCooldown--;
+void bossAttackPattern(GameState* game) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+
+    if (!game->boss.isActive || game->boss.attackCooldown > 0) {
+        game->boss.attackCooldown--;
         return;
     }
 
+    int rowDistance = abs(cellRow(grid, game->boss.position) - cellRow(grid, player->position));
+    int colDistance = abs(cellCol(grid, game->boss.position) - cellCol(grid, player->position));
+
     // Update phase based on health more frequently
-    if (boss.health <= 30) boss.phaseNumber = 3;
-    else if (boss.health <= 60) boss.phaseNumber = 2;
-    else boss.phaseNumber = 1;
+    if (game->boss.health <= 30) game->boss.phaseNumber = 3;
+    else if (game->boss.health <= 60) game->boss.phaseNumber = 2;
+    else game->boss.phaseNumber = 1;
 
-    switch (boss.phaseNumber) {
+    switch (game->boss.phaseNumber) {
         case 1: // Direct attack - more aggressive
-            if (abs(boss.position->x - player->position->x) < 3 &&
-                abs(boss.position->y - player->position->y) < 3) {
+            if (rowDistance < 3 && colDistance < 3) {
                 player->health -= 20;
+                player->lastDamage = DAMAGE_BOSS;
                 strcpy(player->message, " Le boss vous a attaque !");
             }
-            boss.attackCooldown = 1; // Reduced cooldown
+            game->boss.attackCooldown = 1; // Reduced cooldown
             break;
 
         case 2: // Ranged attack - more frequent
-            shootAtPlayer(graph, player);
-            boss.attackCooldown = 2;
+            shootAtPlayer(game);
+            game->boss.attackCooldown = 2;
             break;
 
         case 3: // Final phase - more deadly
-            if (rand() % 2 == 0) {
-                if (abs(boss.position->x - player->position->x) < 4 &&
-                    abs(boss.position->y - player->position->y) < 4) {
+            if (rngNext(&game->rng) % 2 == 0) {
+                if (rowDistance < 4 && colDistance < 4) {
                     player->health -= 25;
+                    player->lastDamage = DAMAGE_BOSS;
                     strcpy(player->message, " Le boss vous a porte un coup devastateur !");
                 }
             } else {
-                shootAtPlayer(graph, player);
+                shootAtPlayer(game);
             }
-            boss.attackCooldown = 2;
+            game->boss.attackCooldown = 2;
             break;
     }
 }
 
 
-void initializeGame(Node* graph[ROWS][COLS], Player* player, GameConfig* config) {
+// Start a new game on the session's grid, which keeps its storage across games
+void initializeGame(GameState* game, const GameConfig* config) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+
+    game->config = *config;
+
     // Initialize map
-    initGraphFromMap(graph, player, config->mapData);
+    initGraphFromMap(grid, player, game->config.mapData);
 
     // Setup enemies with custom parameters
-    for (int i = 0; i < config->crocodileCount; i++) {
-        crocodiles[i].position = NULL;
-        initQueue(&crocodiles[i].movementQueue);
+    for (int i = 0; i < game->config.crocodileCount; i++) {
+        game->crocodiles[i].position = NO_CELL;
+        initQueue(&game->crocodiles[i].movementQueue);
     }
 
-    for (int i = 0; i < config->snakeCount; i++) {
-        snakes[i].position = NULL;
-        snakes[i].health = config->snakeHealth;
-        snakes[i].shootCooldown = 0;
+    for (int i = 0; i < game->config.snakeCount; i++) {
+        game->snakes[i].position = NO_CELL;
+        game->snakes[i].health = game->config.snakeHealth;
+        game->snakes[i].shootCooldown = 0;
     }
 
     // Update game parameters
-    activeSnakes = config->snakeCount;
-    activeCrocodiles = config->crocodileCount;
+    game->activeSnakes = game->config.snakeCount;
+    game->activeCrocodiles = game->config.crocodileCount;
 
     // Call setup functions with the new configuration
-    setupCrocodiles(graph, config);
-    setupSnakes(graph, config);
+    setupCrocodiles(game);
+    setupSnakes(game);
 
 
     player->health = 100;
     player->score = 0;
-    player->inventory = NULL;
+    memset(player->inventory, 0, sizeof(player->inventory));
     player->hasGun = 0;
-    initCheckpointStack(&player->checkpoints);
+    player->readyForBoss = 0;
+    player->hasQuit = 0;
+    player->lastDamage = DAMAGE_NONE;
+    initCheckpointStack(&player->checkpoints, game->config.checkpointDepth);
     strcpy(player->message, "");
+
+    // The boss only exists once the arena is entered
+    game->boss.isActive = 0;
+    game->boss.position = NO_CELL;
+    clearProjectiles(&game->projectiles);
+    game->tickCount = 0;
+    seedRng(&game->rng, game->config.seed);
+}
+
+// Start a new game in storage that may still hold a finished one; the grid
+// and flow field buffers are kept for the new game to reuse
+void resetGame(GameState* game, const GameConfig* config) {
+    cleanupCrocodiles(game);
+    cleanupSnakes(game);
+    clearCheckpointStack(&game->player.checkpoints);
+    initializeGame(game, config);
+}
+
+// Free everything a game holds once it is not played any more
+void cleanupGame(GameState* game) {
+    cleanupCrocodiles(game);
+    cleanupSnakes(game);
+    clearCheckpointStack(&game->player.checkpoints);
+    cleanupGraph(&game->grid);
+    cleanupFlowField(&game->flowField);
 }
-void breakThorns(Player *player, Node *graph[ROWS][COLS], char direction) {
-    Node *targetNode = NULL;
+void breakThorns(GameState* game, char direction) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
 
-    // Determine target node based on direction
-    if (direction == 'z' && player->position->up) targetNode = player->position->up;
-    if (direction == 's' && player->position->down) targetNode = player->position->down;
-    if (direction == 'q' && player->position->left) targetNode = player->position->left;
-    if (direction == 'd' && player->position->right) targetNode = player->position->right;
+    // Determine target cell based on direction
+    int target = cellNeighbor(grid, player->position, direction);
 
-    // Check if target node exists and is thorns
-    if (!targetNode || targetNode->type != THORNS) {
+    // Check if target cell exists and is thorns
+    if (target == NO_CELL || gridType(grid, target) != THORNS) {
         strcpy(player->message, " Aucunes epines a casser dans cette direction !");
         return;
     }
 
     // Check for axe in inventory
-    InventoryItem *current = player->inventory;
-    while (current) {
-        if (strcmp(current->name, "Axe") == 0 && current->quantity > 0) {
-            removeInventoryItem(player, "Axe");
-            targetNode->type = SAFE_LAND;
-            strcpy(player->message, " Epines cassees avec la hache !");
-            return;
-        }
-        current = current->next;
+    if (removeInventoryItem(player, ITEM_AXE)) {
+        gridSetType(grid, target, SAFE_LAND);
+        strcpy(player->message, " Epines cassees avec la hache !");
+        return;
     }
 
     strcpy(player->message, " Vous n'avez pas de hache !");
 }
 
 
-void shootBullet(Player *player, Node *graph[ROWS][COLS], char direction) {
+void shootBullet(GameState* game, char direction) {
+    Player* player = &game->player;
+
    // First check if player has found a gun
     if (!player->hasGun) {
         strcpy(player->message, " Vous n'avez pas d'arme !");
@@ -1076,154 +1654,191 @@ void shootBullet(Player *player, Node *graph[ROWS][COLS], char direction) {
     }
 
     // Then check for ammunition
-    InventoryItem *current = player->inventory;
-    int hasAmmo = 0;
-    while (current) {
-        if (strcmp(current->name, "Bullets") == 0) {
-            if (current->quantity <= 0) {
-                strcpy(player->message, " Pas de munitions !");
-                return;
-            }
-            current->quantity--;
-            hasAmmo = 1;
-            break;
-        }
-        current = current->next;
-    }
-
-    if (!hasAmmo) {
+    if (!removeInventoryItem(player, ITEM_BULLETS)) {
         strcpy(player->message, " Pas de munitions !");
         return;
     }
 
-    Node *bulletPos = player->position;
-    int dx = 0, dy = 0;
+    int dRow, dCol;
+    directionDelta(direction, &dRow, &dCol);
+    spawnProjectile(&game->projectiles, player->position, dRow, dCol, OWNER_PLAYER, 0);
+}
+
+// Apply a player bullet hit to whatever enemy stands on the cell
+void hitEnemy(GameState* game, int cell) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+
+    gridSetHealth(grid, cell, gridHealth(grid, cell) - 1);
+
+    // Handle different enemy types
+    if (cell == game->boss.position) {
+        game->boss.health -= 10;
+        strcpy(player->message, " Vous avez touche le boss !");
+        if (game->boss.health <= 0) {
+            strcpy(player->message, " Le boss a ete vaincu !");
+            player->score += 500;
+        }
+    }
+    else if (gridHealth(grid, cell) <= 0) {
+        if (gridType(grid, cell) == CROCODILE) {
+            strcpy(player->message, " Crocodile tue ! +100 points !");
+            player->score += 100;
+        } else {
+            strcpy(player->message, " Serpent tue ! +75 points !");
+            player->score += 75;
+        }
+        gridSetType(grid, cell, SAFE_LAND);
+    } else {
+        if (gridType(grid, cell) == CROCODILE) {
+            strcpy(player->message, " Crocodile touche ! Encore un coup !");
+        } else {
+            sprintf(player->message, " Serpent touche ! Encore %d coups !",
+                   gridHealth(grid, cell));
+        }
+    }
+}
+
+// Launch a projectile from a cell; it starts moving on the next update.
+// Returns 0 when the pool is full and the shot is lost.
+int spawnProjectile(ProjectilePool* pool, int cell, int dRow, int dCol, ProjectileOwner owner, int damage) {
+    if (pool->count == MAX_PROJECTILES || (dRow == 0 && dCol == 0)) return 0;
+
+    Projectile* projectile = &pool->items[pool->count++];
+    projectile->cell = cell;
+    projectile->dRow = dRow;
+    projectile->dCol = dCol;
+    projectile->owner = owner;
+    projectile->damage = damage;
+    return 1;
+}
 
-   if (direction == 'z') dy = -1;  // Move up 
-   else if (direction == 's') dy = 1;  // Move down 
-   else if (direction == 'q') dx = -1;  // Move left 
-   else if (direction == 'd') dx = 1;  // Move right
+// Steps along (dRow, dCol) from one cell to another, or -1 when the line misses it
+static int stepsAlong(const Grid* grid, int from, int to, int dRow, int dCol) {
+    int rows = cellRow(grid, to) - cellRow(grid, from);
+    int cols = cellCol(grid, to) - cellCol(grid, from);
+    int steps = dRow != 0 ? rows * dRow : cols * dCol;
+    if (steps < 0 || rows != steps * dRow || cols != steps * dCol) return -1;
+    return steps;
+}
 
+// Move one projectile forward; returns 0 once it has hit something.
+// The stored free runs let it cover its whole move in one go instead of
+// testing every cell on the way.
+static int advanceProjectile(GameState* game, Projectile* projectile) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+    int direction = rayDirection(projectile->dRow, projectile->dCol);
+    int left = game->config.projectileSpeed;
 
     while (1) {
-        int newX = bulletPos->x + dx;
-        int newY = bulletPos->y + dy;
+        // Safe land ahead; one more step reaches the cell that stops the projectile
+        int run = direction < 0 ? 0 : rayLength(grid, projectile->cell, direction);
+
+        // Enemy fire hits the player, even if the player walked into it
+        if (projectile->owner != OWNER_PLAYER) {
+            int steps = stepsAlong(grid, projectile->cell, player->position, projectile->dRow, projectile->dCol);
+            if (steps >= 0 && steps <= left && steps <= run + 1) {
+                player->health -= projectile->damage;
+                player->lastDamage = projectile->owner == OWNER_SNAKE ? DAMAGE_SNAKE : DAMAGE_BOSS;
+                if (projectile->owner == OWNER_SNAKE) strcpy(player->message, " Touch par un serpent !");
+                else strcpy(player->message, " Le boss vous a touche avec son attaque a distance !");
+                return 0;
+            }
+        }
+
+        // A shot with no direction stays put for as long as its cell is free
+        if (direction < 0) return gridType(grid, projectile->cell) == SAFE_LAND;
+
+        if (left <= run || run == RAY_LIMIT) {
+            int steps = left < run ? left : run;
+            projectile->cell = cellIndex(grid, cellRow(grid, projectile->cell) + steps * projectile->dRow,
+                                         cellCol(grid, projectile->cell) + steps * projectile->dCol);
+            left -= steps;
+            if (left == 0) return 1;
+            continue;  // The run goes on past what is stored
+        }
 
-        if (newX < 0 || newX >= ROWS || newY < 0 || newY >= COLS) break;
-        if (graph[newX][newY]->type != SAFE_LAND) {
+        int next = cellIndex(grid, cellRow(grid, projectile->cell) + (run + 1) * projectile->dRow,
+                             cellCol(grid, projectile->cell) + (run + 1) * projectile->dCol);
+        if (next == NO_CELL) return 0;
+
+        // The player's own cell never stops a projectile, whatever lies on it
+        if (next == player->position) {
+            projectile->cell = next;
+            left -= run + 1;
+            continue;
+        }
+
+        if (projectile->owner == OWNER_PLAYER) {
             // Handle hitting different types of enemies
-            if (graph[newX][newY]->type == CROCODILE ||
-                graph[newX][newY]->type == SNAKE ||
-                graph[newX][newY] == boss.position) {  // Add boss check here
-
-                graph[newX][newY]->health--;
-
-                // Handle different enemy types
-                if (graph[newX][newY] == boss.position) {
-                    boss.health -= 10;
-                    strcpy(player->message, " Vous avez touche le boss !");
-                    if (boss.health <= 0) {
-                        strcpy(player->message, " Le boss a ete vaincu !");
-                        player->score += 500;
-                    }
-                }
-                else if (graph[newX][newY]->health <= 0) {
-                    if (graph[newX][newY]->type == CROCODILE) {
-                        strcpy(player->message, " Crocodile tue ! +100 points !");
-                        player->score += 100;
-                    } else {
-                        strcpy(player->message, " Serpent tue ! +75 points !");
-                        player->score += 75;
-                    }
-                    graph[newX][newY]->type = SAFE_LAND;
-                } else {
-                    if (graph[newX][newY]->type == CROCODILE) {
-                        strcpy(player->message, " Crocodile touche ! Encore un coup !");
-                    } else {
-                        sprintf(player->message, " Serpent touche ! Encore %d coups !",
-                               graph[newX][newY]->health);
-                    }
-                }
+            CellType type = gridType(grid, next);
+            if (type == CROCODILE || type == SNAKE || next == game->boss.position) {
+                hitEnemy(game, next);
             } else {
                 strcpy(player->message, " La balle a heurté un obstacle !");
             }
-            break;
         }
+        return 0;
+    }
+}
 
-        bulletPos = graph[newX][newY];
-        bulletPos->type = BULLET;
-        displayGraph(graph, player);
-        usleep(100000);
-        bulletPos->type = SAFE_LAND;
-    }
-}
-void addInventoryItem(Player *player, const char *itemName) {
-    InventoryItem *current = player->inventory;
-    // Check if item already exists
-    while (current) {
-        if (strcmp(current->name, itemName) == 0) {
-            // Add 5 if it's a gun, 1 otherwise
-            if (strcmp(itemName, "Bullets") == 0) {
-                current->quantity += 7;
-            } else {
-                current->quantity++;
-            }
-            return;
+// Advance every live projectile; spent ones are swapped out with the last live one
+void updateProjectiles(GameState* game) {
+    ProjectilePool* pool = &game->projectiles;
+    int i = 0;
+    while (i < pool->count) {
+        if (advanceProjectile(game, &pool->items[i])) {
+            i++;
+        } else {
+            pool->items[i] = pool->items[--pool->count];
         }
-        current = current->next;
     }
+}
 
-    // If item doesn't exist, create new item
-    InventoryItem *newItem = (InventoryItem*)malloc(sizeof(InventoryItem));
-    strcpy(newItem->name, itemName);
-    // Set initial quantity - 5 for gun, 1 for others
-    if (strcmp(itemName, "Bullets") == 0) {
-        newItem->quantity = 7;
-    } else {
-        newItem->quantity = 1;
-    }
-    newItem->next = player->inventory;
-    player->inventory = newItem;
+void clearProjectiles(ProjectilePool* pool) {
+    pool->count = 0;
 }
-int removeInventoryItem(Player *player, const char *itemName) {
-    InventoryItem *current = player->inventory;
-    InventoryItem *previous = NULL;
 
-    while (current) {
-        if (strcmp(current->name, itemName) == 0) {
-            if (current->quantity > 1) {
-                current->quantity--;
-                return 1;
-            } else {
-                // Remove the item completely
-                if (previous) {
-                    previous->next = current->next;
-                } else {
-                    player->inventory = current->next;
-                }
-                free(current);
-                return 1;
-            }
-        }
-        previous = current;
-        current = current->next;
+static const ItemInfo itemTable[ITEM_KIND_COUNT] = {
+    [ITEM_BULLETS]     = {GUN, 7, 0, 1, " Vous avez trouve des munitions !"},
+    [ITEM_AXE]         = {AXE, 1, 0, 0, " Vous avez trouve une hache !"},
+    [ITEM_FOOD]        = {FOOD, 1, 20, 0, " Vous avez trouve de la nourriture !"},
+    [ITEM_HEALTH_PACK] = {HEALTH_PACK, 1, 0, 0, " Vous avez trouve un pack de sante !"}
+};
+
+// Item lying on a cell of this type, or NO_ITEM
+int itemAtCell(CellType type) {
+    for (int kind = 0; kind < ITEM_KIND_COUNT; kind++) {
+        if (itemTable[kind].cell == type) return kind;
     }
-    return 0;
+    return NO_ITEM;
+}
+
+void addInventoryItem(Player *player, ItemKind kind) {
+    player->inventory[kind] += itemTable[kind].pickupAmount;
+}
+
+// Use up one unit of an item; returns 0 if the player has none
+int removeInventoryItem(Player *player, ItemKind kind) {
+    if (player->inventory[kind] <= 0) return 0;
+    player->inventory[kind]--;
+    return 1;
 }
 
-void displayInventory(Player *player) {
-    printf("Inventaire:\n");
-    InventoryItem *current = player->inventory;
-    while (current) {
-        printf("- %s\n", current->name);
-        current = current->next;
+// Show the inventory in the prompt area; the front-end clears it on the next key
+void displayInventory(Renderer* renderer, Player *player) {
+    char line[SCREEN_WIDTH + 1] = "Inventaire:";
+    for (int kind = 0; kind < ITEM_KIND_COUNT; kind++) {
+        if (player->inventory[kind] <= 0) continue;
+        size_t length = strlen(line);
+        snprintf(line + length, sizeof(line) - length, " %s x%d", itemNames[kind], player->inventory[kind]);
     }
-    printf("Appuyez sur une touche pour continuer...\n");
-    _getch();
+    setPrompt(renderer, line, "Appuyez sur une touche pour continuer...");
 }
 
 void useHealthPack(Player *player) {
-    if (removeInventoryItem(player, "Health Pack")) {
+    if (removeInventoryItem(player, ITEM_HEALTH_PACK)) {
         player->health += 50;
         strcpy(player->message, " Vous avez utilise un pack de sante !");
     } else {
@@ -1231,56 +1846,46 @@ void useHealthPack(Player *player) {
     }
 }
 
-void movePlayer(Player *player, char direction, Node *graph[ROWS][COLS]) {
-    Node *newPos = player->position;
-if (direction == 'z' && player->position->up) newPos = player->position->up;  // Move up
-if (direction == 's' && player->position->down) newPos = player->position->down;  // Move down
-if (direction == 'q' && player->position->left) newPos = player->position->left;  // Move left
-if (direction == 'd' && player->position->right) newPos = player->position->right;  // Move right
+void movePlayer(GameState* game, char direction) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+    int newPos = cellNeighbor(grid, player->position, direction);  // z/s/q/d: up, down, left, right
 
-    if (newPos == player->position) {
+    if (newPos == NO_CELL) {
         return; // No movement
     }
-    if (newPos->type == WALL) {
+    CellType newType = (CellType)gridType(grid, newPos);
+    if (newType == WALL) {
         strcpy(player->message, " Vous ne pouvez pas traverser les murs !");
         return;
     }
 
-    if (newPos->type == THORNS) {
+    if (newType == THORNS) {
     strcpy(player->message, " Vous ne pouvez pas vous deplacer ici !");
     player->health -= 10;
+    player->lastDamage = DAMAGE_THORNS;
 #ifdef _WIN32
     Beep(800, 300);  // Play sound (Windows only)
 #endif
 
 
 
-    } else if (newPos->type == CROCODILE || newPos->type == SNAKE) {
+    } else if (newType == CROCODILE || newType == SNAKE) {
         strcpy(player->message, " Vous avez rencontre un ennemi !");
         player->health -= 20;
+        player->lastDamage = newType == CROCODILE ? DAMAGE_CROCODILE : DAMAGE_SNAKE;
     } else {
         player->position = newPos;
-        if (newPos->type == GUN) {
-        strcpy(player->message, " Vous avez trouve des munitions !");
-        addInventoryItem(player, "Bullets");
-        newPos->type = SAFE_LAND;
-        player->hasGun = 1;
-    }
-        else if (newPos->type == AXE) {
-            strcpy(player->message, " Vous avez trouve une hache !");
-            addInventoryItem(player, "Axe");
-            newPos->type = SAFE_LAND;
-    }   else if (newPos->type == FOOD) {
-            strcpy(player->message, " Vous avez trouve de la nourriture !");
-            player->health += 20;
-            addInventoryItem(player, "Food");
-            newPos->type = SAFE_LAND;
-    }    else if (newPos->type == HEALTH_PACK) {
-            strcpy(player->message, " Vous avez trouve un pack de sante !");
-            addInventoryItem(player, "Health Pack");
-            newPos->type = SAFE_LAND;
-        }else if (newPos->type == CHECKPOINT) {
-                handleCheckpoint(player, newPos);
+        int item = itemAtCell(newType);
+        if (item != NO_ITEM) {
+            const ItemInfo* info = &itemTable[item];
+            strcpy(player->message, info->pickupMessage);
+            addInventoryItem(player, (ItemKind)item);
+            player->health += info->healthBonus;
+            if (info->armsPlayer) player->hasGun = 1;
+            gridSetType(grid, newPos, SAFE_LAND);
+        }else if (newType == CHECKPOINT) {
+                handleCheckpoint(game, newPos);
         }else {
             strcpy(player->message, "");
         }
@@ -1300,149 +1905,1052 @@ if (direction == 'd' && player->position->right) newPos = player->position->righ
 }
 
 
-int dangerWarning(Player *player, Node *graph[ROWS][COLS]) {
-    int px = player->position->x;
-    int py = player->position->y;
+// Number of enemies close to the player, looked up from the threat data
+int dangerWarning(Player *player, Grid *grid) {
+    return threatCount(grid, player->position);
+}
 
-    for (int i = px - 5; i <= px + 5; i++) {
-        for (int j = py - 5; j <= py + 5; j++) {
-            // Skip iterations for coordinates outside the grid
-            if (i >= 0 && i < ROWS && j >= 0 && j < COLS) {
-                if (graph[i][j]->type == CROCODILE || graph[i][j]->type == SNAKE) {
-                    return 1;  // Danger detected
-                }
-            }
-        }
+// Map a movement key (z/s/q/d) onto the matching variant of a directional action
+Action directionalAction(Action upAction, char direction) {
+    switch (direction) {
+        case 'z': return upAction;
+        case 's': return (Action)(upAction + 1);
+        case 'q': return (Action)(upAction + 2);
+        case 'd': return (Action)(upAction + 3);
+        default: return ACTION_NONE;
+    }
+}
+
+// Map a single key press onto an action. Keys that need a second key
+// (shoot, break thorns) or that only touch the display map to ACTION_NONE.
+Action actionFromKey(char key) {
+    switch (key) {
+        case 'z': case 's': case 'q': case 'd':
+            return directionalAction(ACTION_MOVE_UP, key);
+        case 'u': return ACTION_USE_HEALTH_PACK;
+        case 'r': return ACTION_RETURN_CHECKPOINT;
+        case 'x': return ACTION_QUIT;
+        default: return ACTION_NONE;
     }
+}
+
+GameStatus gameStatus(GameState* game) {
+    Player* player = &game->player;
+
+    if (player->hasQuit) return GAME_QUIT;
+    if (player->health <= 0) return GAME_PLAYER_DEAD;
+    if (game->boss.isActive && game->boss.health <= 0) return GAME_BOSS_DEFEATED;
+    if (player->readyForBoss) return GAME_ARENA_READY;
+    if (!game->boss.isActive && gridType(&game->grid, player->position) == PORTAL) return GAME_AT_PORTAL;
+    return GAME_RUNNING;
+}
 
-    return 0;  // No danger found after checking all tiles within radius
+// A session is done once nothing more can happen on the current map
+int isGameDone(GameState* game) {
+    GameStatus status = gameStatus(game);
+    return status != GAME_RUNNING && status != GAME_AT_PORTAL;
 }
 
-void gameLoop(Node* graph[ROWS][COLS], Player *player) {
-    char input;
+static void journalBeginTick(RewindJournal* journal, const GameState* game);
+static void journalEndTick(RewindJournal* journal, const GameState* game);
+
+// The player's half of a tick: the action, then the bullets in flight.
+// Returns 0 when the tick ends there and the enemies get no turn.
+static int playerTurn(GameState* game, Action action) {
+    static const char directionKeys[4] = {'z', 's', 'q', 'd'};
+    Player* player = &game->player;
+
+    if (action >= ACTION_MOVE_UP && action <= ACTION_MOVE_RIGHT) {
+        movePlayer(game, directionKeys[action - ACTION_MOVE_UP]);
+    } else if (action >= ACTION_SHOOT_UP && action <= ACTION_SHOOT_RIGHT) {
+        shootBullet(game, directionKeys[action - ACTION_SHOOT_UP]);
+    } else if (action >= ACTION_BREAK_UP && action <= ACTION_BREAK_RIGHT) {
+        breakThorns(game, directionKeys[action - ACTION_BREAK_UP]);
+    } else if (action == ACTION_USE_HEALTH_PACK) {
+        useHealthPack(player);
+    } else if (action == ACTION_RETURN_CHECKPOINT) {
+        returnToLastCheckpoint(player);
+    } else if (action == ACTION_ENTER_ARENA) {
+        if (gameStatus(game) == GAME_AT_PORTAL) player->readyForBoss = 1;
+        return 0;
+    } else if (action == ACTION_QUIT) {
+        player->hasQuit = 1;
+        return 0;
+    }
+
+    // Bullets already in flight move before anyone else acts
+    updateProjectiles(game);
+
+    // Check if boss is defeated
+    if (game->boss.isActive && game->boss.health <= 0) {
+        strcpy(player->message, "Felicitations! Vous avez vaincu le boss !");
+        player->score += 500;  // Add bonus score for defeating boss
+        return 0;
+    }
 
+    // The enemies don't act on a player who just died
+    return player->health > 0;
+}
+
+// A new tick up to the end of the player's half. Returns 1 when the
+// enemies' half follows (see enemyTurn).
+int playerTick(GameState* game, Action action) {
+    game->tickCount++;
+    if (!playerTurn(game, action)) return 0;
+
+    // Enemies only take a turn every few ticks so they keep a playable pace
+    return game->tickCount % game->config.enemyTurnTicks == 0;
+}
+
+// The enemies' half of a tick
+void enemyTurn(GameState* game) {
+    // Boss actions if active
+    if (game->boss.isActive) {
+        bossAttackPattern(game);  // Boss attack pattern
+        moveBoss(game);  // Move the boss
+    } else {
+        // Non-boss actions
+        handleAllSnakesShooting(game);  // Handle snake shooting
+        moveAllCrocodiles(game);  // Move crocodiles
+    }
+}
+
+// One tick of gameStep, without the journal
+static void advanceGame(GameState* game, Action action) {
+    if (playerTick(game, action)) enemyTurn(game);
+}
+
+// Advance the world by one tick: apply the player's action, then let the enemies act.
+// Nothing here renders, sleeps or reads the terminal.
+void gameStep(GameState* game, Action action) {
+    RewindJournal* journal = game->grid.journal;
+
+    if (isGameDone(game)) return;
+    if (journal == NULL) {
+        advanceGame(game, action);
+        return;
+    }
+    journalBeginTick(journal, game);
+    advanceGame(game, action);
+    journalEndTick(journal, game);
+}
+
+// Set up the boss arena once the game asks for it. Returns 0 if the game
+// did not ask, 1 if the arena was set up just now and -1 if it could not
+// be, which ends the game (see initializeBoss).
+int enterArenaIfReady(GameState* game) {
+    if (gameStatus(game) != GAME_ARENA_READY) return 0;
+    return initializeBoss(game, bossMap) ? 1 : -1;
+}
+
+// One tick for the front-ends without a screen to announce the arena on:
+// it follows straight away
+void headlessStep(GameState* game, Action action) {
+    gameStep(game, action);
+    enterArenaIfReady(game);
+}
+
+// Turn the terminal's line buffering and echo off for the whole game loop,
+// instead of switching modes around every key press
+void setRawMode(int enable) {
+#ifndef _WIN32
+    static struct termios savedMode;
+    static int rawActive = 0;
+
+    if (enable && !rawActive) {
+        struct termios raw;
+        if (tcgetattr(STDIN_FILENO, &savedMode) != 0) return;  // Not a terminal
+        raw = savedMode;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        rawActive = 1;
+    } else if (!enable && rawActive) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedMode);
+        rawActive = 0;
+    }
+#else
+    (void)enable;  // _getch already reads unbuffered keys
+#endif
+}
+
+// Wait up to timeoutMs for a key (forever if negative).
+// Returns the key, KEY_NONE on timeout or KEY_CLOSED at end of input.
+int waitForKey(int timeoutMs) {
+#ifdef _WIN32
+    DWORD start = GetTickCount();
+    while (!_kbhit()) {
+        if (timeoutMs >= 0 && GetTickCount() - start >= (DWORD)timeoutMs) return KEY_NONE;
+        Sleep(1);
+    }
+    return _getch();
+#else
+    struct pollfd input = { STDIN_FILENO, POLLIN, 0 };
+    unsigned char key;
+
+    if (poll(&input, 1, timeoutMs) <= 0) return KEY_NONE;
+    if (read(STDIN_FILENO, &key, 1) != 1) return KEY_CLOSED;
+    return key;
+#endif
+}
+
+long long monotonicMs(void) {
+#ifdef _WIN32
+    return (long long)GetTickCount64();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+#endif
+}
+
+// Turn one key press into an action. Keys that open a prompt (shoot and thorn
+// directions, inventory) are remembered in pendingKey and complete on the next key.
+Action actionFromInput(Renderer* renderer, GameState* game, int key, char* pendingKey) {
+    char pending = *pendingKey;
+
+    if (pending != 0) {
+        *pendingKey = 0;
+        setPrompt(renderer, "", "");
+        if (pending == 'f') return directionalAction(ACTION_SHOOT_UP, (char)key);
+        if (pending == 'c') return directionalAction(ACTION_BREAK_UP, (char)key);
+        return ACTION_NONE;  // The key only closed the inventory
+    }
+
+    switch (key) {
+        case 'f':
+            setPrompt(renderer, "", "Shoot direction? [z] Up, [s] Down, [q] Left, [d] Right");
+            *pendingKey = 'f';
+            return ACTION_NONE;
+        case 'c':
+            setPrompt(renderer, "", "Thorn direction? [z] Up, [s] Down, [q] Left, [d] Right");
+            *pendingKey = 'c';
+            return ACTION_NONE;
+        case 'i':
+            displayInventory(renderer, &game->player);  // Display inventory
+            *pendingKey = 'i';
+            return ACTION_NONE;
+        case '1':
+            if (gameStatus(game) == GAME_AT_PORTAL) return ACTION_ENTER_ARENA;  // Ready for boss battle
+            return ACTION_NONE;
+        default:
+            return actionFromKey((char)key);
+    }
+}
+
+// Keep a key for the next tick; keys beyond the buffer are dropped
+void queueKey(KeyInput* input, int key) {
+    if (input->count < KEY_BUFFER_SIZE) input->keys[input->count++] = key;
+}
+
+// Offer the arena for as long as the player stands on the portal, unless a
+// prompt waits for its second key. Returns 1 when the offer appears or goes.
+int showPortalPrompt(Renderer* renderer, GameStatus status, KeyInput* input) {
+    if (status == GAME_AT_PORTAL && input->pendingKey == 0) {
+        if (input->portalPrompt) return 0;
+        setPrompt(renderer, " Vous avez atteint le portail!", "[1] Enter the boss arena, [2] Continue exploring the current map");
+        input->portalPrompt = 1;
+        return 1;
+    }
+    if (!input->portalPrompt) return 0;
+    if (input->pendingKey == 0) setPrompt(renderer, "", "");
+    input->portalPrompt = 0;
+    return 1;
+}
+
+// Use the buffered keys up to the first one that makes the player act; the
+// others wait for the next tick
+Action takeKeyAction(Renderer* renderer, GameState* game, KeyInput* input) {
+    Action action = ACTION_NONE;
+    int used = 0;
+    while (used < input->count && action == ACTION_NONE) {
+        action = actionFromInput(renderer, game, input->keys[used++], &input->pendingKey);
+    }
+    input->count -= used;
+    memmove(input->keys, input->keys + used, input->count * sizeof(input->keys[0]));
+    return action;
+}
+
+// Interactive front-end: run the simulation at a fixed tick rate and feed it
+// the keys that arrived since the previous tick
+void gameLoop(GameState* game, ReplayWriter* recorder) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+    int termRows, termCols;
+    KeyInput input = {0};
+    int tickMs = 1000 / game->config.tickRateHz;
+
+    // Size the frame to the map, but never beyond the terminal
+    terminalSize(&termRows, &termCols);
+    int width = grid->cols * 2 > SCREEN_WIDTH ? grid->cols * 2 : SCREEN_WIDTH;
+    int height = grid->rows + HUD_LINES;
+    if (width > termCols) width = termCols;
+    if (height > termRows) height = termRows;
+    if (height < HUD_LINES + 1) height = HUD_LINES + 1;
+
+    setRawMode(1);
+    rendererBegin(&screen, STDOUT_FILENO, width, height);
+    long long nextTick = monotonicMs() + tickMs;
     while (1) {
+        GameStatus status = gameStatus(game);
+
         // Check if player is defeated
-        if (player->health <= 0) {
+        if (status == GAME_PLAYER_DEAD) {
             strcpy(player->message, "Game Over - Vous avez ete vaincu !");
-            printf("\nPress any key to quit...\n");
-            _getch();  // Wait for input
-            return;
+            setPrompt(&screen, "", "Press any key to quit...");
+            displayGraph(&screen, game);
+            waitForKey(-1);  // Wait for input
+            break;
         }
 
         // Check if boss is defeated
-        if (boss.isActive && boss.health <= 0) {
-            strcpy(player->message, "Felicitations! Vous avez vaincu le boss !");
-            player->score += 500;  // Add bonus score for defeating boss
-            printf("\nPress any key to quit...\n");
-            _getch();  // Wait for input
-            return;
+        if (status == GAME_BOSS_DEFEATED) {
+            setPrompt(&screen, "", "Press any key to quit...");
+            displayGraph(&screen, game);
+            waitForKey(-1);  // Wait for input
+            break;
         }
 
-        // Boss actions if active
-        if (boss.isActive) {
-            bossAttackPattern(graph, player);  // Boss attack pattern
-            moveBoss(graph, player);  // Move the boss
-        } else {
-            // Non-boss actions
-            handleAllSnakesShooting(graph, player);  // Handle snake shooting
-            moveAllCrocodiles(graph, player);  // Move crocodiles
+        if (status == GAME_QUIT || status == GAME_ARENA_READY) break;
+
+        showPortalPrompt(&screen, status, &input);
+        displayGraph(&screen, game);  // Display the current game state
+
+        // Collect keys until the next tick is due
+        while (1) {
+            long long wait = nextTick - monotonicMs();
+            int key = waitForKey(wait > 0 ? (int)wait : 0);
+            if (key == KEY_NONE) break;
+            if (key == KEY_CLOSED) key = 'x';  // No more input, leave the game
+            queueKey(&input, key);
+            if (wait <= 0) break;
+        }
+
+        Action action = takeKeyAction(&screen, game, &input);
+        if (recorder != NULL) replayRecord(recorder, game->tickCount + 1, action);  // The tick this action runs on
+        gameStep(game, action);
+
+        // Tick on a fixed schedule, but don't try to catch up after a long stall
+        nextTick += tickMs;
+        if (monotonicMs() - nextTick > 10 * tickMs) nextTick = monotonicMs() + tickMs;
+    }
+    rendererEnd(&screen);
+    setRawMode(0);
+}
+void seedRng(GameRng* rng, unsigned long long seed) {
+    rng->state = seed ? seed : 0x9E3779B97F4A7C15ull;  // xorshift must not start at 0
+}
+
+unsigned int rngNext(GameRng* rng) {
+    rng->state ^= rng->state >> 12;
+    rng->state ^= rng->state << 25;
+    rng->state ^= rng->state >> 27;
+    return (unsigned int)((rng->state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static unsigned long long hashBytes(unsigned long long hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;  // FNV-1a
+    }
+    return hash;
+}
+
+// Fingerprint of everything a replay must reproduce
+unsigned long long hashGameState(GameState* game) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+    unsigned long long hash = 0xCBF29CE484222325ull;
+    int values[] = {player->position, player->health, player->score, player->hasGun,
+                    game->boss.isActive, game->boss.health, game->boss.position};
+
+    hash = hashBytes(hash, values, sizeof(values));
+    hash = hashBytes(hash, player->inventory, sizeof(player->inventory));
+    hash = hashBytes(hash, &game->tickCount, sizeof(game->tickCount));
+    for (int i = 0; i < game->activeCrocodiles; i++) hash = hashBytes(hash, &game->crocodiles[i].position, sizeof(int));
+    for (int i = 0; i < game->activeSnakes; i++) hash = hashBytes(hash, &game->snakes[i].position, sizeof(int));
+    for (int cell = 0; cell < grid->cellCount; cell++) {
+        unsigned char type = (unsigned char)gridType(grid, cell);
+        hash = hashBytes(hash, &type, 1);
+    }
+    return hash;
+}
+
+// GameConfig fields saved in a replay, in file order
+static const size_t replayConfigFields[] = {
+    offsetof(GameConfig, mapSize), offsetof(GameConfig, enemyCount), offsetof(GameConfig, enemyPower),
+    offsetof(GameConfig, snakeHealth), offsetof(GameConfig, crocodileHealth),
+    offsetof(GameConfig, snakeDamage), offsetof(GameConfig, crocodileDamage),
+    offsetof(GameConfig, snakeCount), offsetof(GameConfig, crocodileCount),
+    offsetof(GameConfig, projectileSpeed), offsetof(GameConfig, tickRateHz),
+    offsetof(GameConfig, enemyTurnTicks), offsetof(GameConfig, crocodileBehavior),
+    offsetof(GameConfig, chaseRadius), offsetof(GameConfig, checkpointDepth)
+};
+#define REPLAY_CONFIG_FIELDS (int)(sizeof(replayConfigFields) / sizeof(replayConfigFields[0]))
+
+// Unsigned LEB128: 7 bits per byte, small numbers take a single byte
+static void writeVarint(FILE* file, unsigned long long value) {
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7F) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+static int readVarint(const unsigned char** cursor, const unsigned char* end, unsigned long long* value) {
+    *value = 0;
+    for (int shift = 0; *cursor < end && shift < 64; shift += 7) {
+        unsigned char byte = *(*cursor)++;
+        *value |= (unsigned long long)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return 1;
+    }
+    return 0;
+}
+
+static void writeFixed64(FILE* file, unsigned long long value) {
+    for (int i = 0; i < 8; i++) fputc((int)(value >> (i * 8)) & 0xFF, file);
+}
+
+static int readFixed64(const unsigned char** cursor, const unsigned char* end, unsigned long long* value) {
+    if (end - *cursor < 8) return 0;
+    *value = 0;
+    for (int i = 0; i < 8; i++) *value |= (unsigned long long)(*cursor)[i] << (i * 8);
+    *cursor += 8;
+    return 1;
+}
+
+// Start recording a session: header, seed, config and the map it is played on
+int replayBegin(ReplayWriter* writer, const char* path, const GameConfig* config) {
+    writer->file = fopen(path, "wb");
+    writer->lastTick = 0;
+    if (writer->file == NULL) return 0;
+
+    size_t mapLength = strlen(config->mapData);
+    fwrite(REPLAY_MAGIC, 1, 4, writer->file);
+    fputc(REPLAY_VERSION, writer->file);
+    writeFixed64(writer->file, config->seed);
+    for (int i = 0; i < REPLAY_CONFIG_FIELDS; i++) {
+        int value = *(const int*)((const char*)config + replayConfigFields[i]);
+        writeVarint(writer->file, (unsigned int)value);
+    }
+    writeVarint(writer->file, mapLength);
+    fwrite(config->mapData, 1, mapLength, writer->file);
+    return 1;
+}
+
+// Log the action taken at a tick. Idle ticks cost nothing: they are folded
+// into the tick delta of the next action.
+void replayRecord(ReplayWriter* writer, unsigned long tick, Action action) {
+    if (writer->file == NULL || action == ACTION_NONE) return;
+    writeVarint(writer->file, tick - writer->lastTick);
+    fputc(action, writer->file);
+    writer->lastTick = tick;
+}
+
+// Close the log with the tick the session ended on and its final state
+void replayEnd(ReplayWriter* writer, unsigned long tick, unsigned long long stateHash) {
+    if (writer->file == NULL) return;
+    writeVarint(writer->file, tick - writer->lastTick);
+    fputc(REPLAY_END, writer->file);
+    writeFixed64(writer->file, stateHash);
+    fclose(writer->file);
+    writer->file = NULL;
+}
+
+// Step the game to the given tick, entering the arena the way the
+// interactive front-end does. Returns 0 if the game ended first.
+static int replayAdvance(GameState* game, unsigned long tick, Action action) {
+    while (game->tickCount < tick) {
+        enterArenaIfReady(game);
+        if (isGameDone(game)) return 0;
+        gameStep(game, game->tickCount + 1 == tick ? action : ACTION_NONE);
+    }
+    return 1;
+}
+
+// Re-run a recorded session headless and check it ends in the recorded state.
+// Returns 1 when it does.
+int replaySession(GameState* game, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("%s: cannot open replay\n", path);
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = (unsigned char*)malloc(size > 0 ? size : 1);
+    size_t length = fread(data, 1, size > 0 ? size : 0, file);
+    fclose(file);
+
+    const unsigned char* cursor = data;
+    const unsigned char* end = data + length;
+    GameConfig replayConfig;
+    unsigned long long value, mapLength, recordedHash;
+    char* map = NULL;
+    int ok = 0;
+
+    memset(&replayConfig, 0, sizeof(replayConfig));
+    if (length < 5 || memcmp(cursor, REPLAY_MAGIC, 4) != 0 || cursor[4] != REPLAY_VERSION) {
+        printf("%s: not a replay file\n", path);
+        free(data);
+        return 0;
+    }
+    cursor += 5;
+    if (!readFixed64(&cursor, end, &replayConfig.seed)) goto malformed;
+    for (int i = 0; i < REPLAY_CONFIG_FIELDS; i++) {
+        if (!readVarint(&cursor, end, &value)) goto malformed;
+        *(int*)((char*)&replayConfig + replayConfigFields[i]) = (int)value;
+    }
+    if (!readVarint(&cursor, end, &mapLength) || mapLength > (unsigned long long)(end - cursor)) goto malformed;
+    map = (char*)malloc(mapLength + 1);
+    memcpy(map, cursor, mapLength);
+    map[mapLength] = '\0';
+    cursor += mapLength;
+    replayConfig.mapData = map;
+
+    strcpy(game->player.name, "replay");
+    resetGame(game, &replayConfig);
+
+    // Actions run at full speed; nothing is rendered
+    unsigned long tick = 0;
+    while (1) {
+        if (!readVarint(&cursor, end, &value) || cursor >= end) goto malformed;
+        tick += (unsigned long)value;
+        int action = *cursor++;
+        if (action == REPLAY_END) break;
+        replayAdvance(game, tick, (Action)action);
+    }
+    replayAdvance(game, tick, ACTION_NONE);
+    if (!readFixed64(&cursor, end, &recordedHash)) goto malformed;
+
+    unsigned long long stateHash = hashGameState(game);
+    ok = game->tickCount == tick && stateHash == recordedHash;
+    printf("%s: %s after %lu ticks (score %d, PV %d)\n", path, ok ? "OK" : "MISMATCH",
+           game->tickCount, game->player.score, game->player.health);
+
+    free(map);
+    free(data);
+    return ok;
+
+malformed:
+    printf("%s: truncated or corrupt replay\n", path);
+    free(map);
+    free(data);
+    return 0;
+}
+
+// Sizes of everything a snapshot copies byte for byte. A snapshot taken by
+// a build where any of them differs is refused rather than misread.
+static unsigned int snapshotLayout(void) {
+    size_t sizes[] = {sizeof(Player), sizeof(GameConfig), sizeof(Crocodile), sizeof(Snake), sizeof(Boss),
+                      sizeof(Projectile), sizeof(MapSpawns), sizeof(GridChunk), MAX_CROCODILES, MAX_SNAKES};
+    return (unsigned int)hashBytes(0xCBF29CE484222325ull, sizes, sizeof(sizes));
+}
+
+static void snapshotPut(unsigned char** cursor, const void* data, size_t size) {
+    memcpy(*cursor, data, size);
+    *cursor += size;
+}
+
+static int snapshotTake(const unsigned char** cursor, const unsigned char* end, void* data, size_t size) {
+    if ((size_t)(end - *cursor) < size) return 0;
+    memcpy(data, *cursor, size);
+    *cursor += size;
+    return 1;
+}
+
+// Bytes saveSnapshot needs for the game as it stands
+size_t snapshotSize(const GameState* game) {
+    const Grid* grid = &game->grid;
+    return sizeof(SnapshotHeader) + sizeof(Player) + sizeof(GameConfig)
+         + sizeof(game->crocodiles) + sizeof(game->snakes) + 2 * sizeof(int) + sizeof(Boss)
+         + sizeof(int) + (size_t)game->projectiles.count * sizeof(Projectile)
+         + sizeof(game->tickCount) + sizeof(game->rng.state)
+         + 4 * sizeof(int) + sizeof(MapSpawns)
+         + gridDirectoryBytes(grid) + (size_t)grid->chunkCount * sizeof(GridChunk);
+}
+
+// Write the whole session into buffer: the player with its checkpoints,
+// the config, the enemies, the boss, live projectiles and the grid, whose
+// directory and chunks go over as one block. The flow field is a cache and
+// is rebuilt after loading. Returns the bytes written, 0 if capacity is short.
+size_t saveSnapshot(const GameState* game, unsigned char* buffer, size_t capacity) {
+    const Grid* grid = &game->grid;
+    size_t length = snapshotSize(game);
+    unsigned char* cursor = buffer;
+    SnapshotHeader header;
+    int gridSize[4] = {grid->rows, grid->cols, grid->chunkCount, grid->raysReady};
+
+    if (capacity < length) return 0;
+    memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+    header.version = SNAPSHOT_VERSION;
+    header.layout = snapshotLayout();
+    header.length = (unsigned int)length;
+
+    snapshotPut(&cursor, &header, sizeof(header));
+    snapshotPut(&cursor, &game->player, sizeof(Player));
+    snapshotPut(&cursor, &game->config, sizeof(GameConfig));
+    snapshotPut(&cursor, game->crocodiles, sizeof(game->crocodiles));
+    snapshotPut(&cursor, &game->activeCrocodiles, sizeof(int));
+    snapshotPut(&cursor, game->snakes, sizeof(game->snakes));
+    snapshotPut(&cursor, &game->activeSnakes, sizeof(int));
+    snapshotPut(&cursor, &game->boss, sizeof(Boss));
+    snapshotPut(&cursor, &game->projectiles.count, sizeof(int));
+    snapshotPut(&cursor, game->projectiles.items, (size_t)game->projectiles.count * sizeof(Projectile));
+    snapshotPut(&cursor, &game->tickCount, sizeof(game->tickCount));
+    snapshotPut(&cursor, &game->rng.state, sizeof(game->rng.state));
+    snapshotPut(&cursor, gridSize, sizeof(gridSize));
+    snapshotPut(&cursor, &grid->spawns, sizeof(MapSpawns));
+    snapshotPut(&cursor, grid->block, gridDirectoryBytes(grid) + (size_t)grid->chunkCount * sizeof(GridChunk));
+    return length;
+}
+
+// A cell index read from a snapshot: on the map, or NO_CELL where allowed
+static int snapshotCell(int cell, int cellCount, int allowNone) {
+    return (cell >= 0 && cell < cellCount) || (allowNone && cell == NO_CELL);
+}
+
+// Whether every field of the player the game indexes or divides by is sound:
+// its cell, the checkpoint ring, the cells of the checkpoints it holds and
+// the cause of its last damage
+static int snapshotPlayerValid(const Player* player, int cellCount) {
+    const CheckpointStack* stack = &player->checkpoints;
+    if (memchr(player->name, '\0', sizeof(player->name)) == NULL ||
+        memchr(player->message, '\0', sizeof(player->message)) == NULL) return 0;
+    if (!snapshotCell(player->position, cellCount, 0)) return 0;
+    if (player->lastDamage < DAMAGE_NONE || player->lastDamage >= DAMAGE_CAUSE_COUNT) return 0;
+    if (stack->depth < 1 || stack->depth > MAX_CHECKPOINTS || stack->top < 0 || stack->top >= stack->depth ||
+        stack->size < 0 || stack->size > stack->depth) return 0;
+    for (int i = 1; i <= stack->size; i++) {
+        if (!snapshotCell(stack->entries[(stack->top + stack->depth - i) % stack->depth].position, cellCount, 0)) {
+            return 0;
         }
+    }
+    return 1;
+}
 
-        displayGraph(graph, player);  // Display the current game state
-
-        // Check if player reaches portal
-        if (player->position->type == PORTAL) {
-            system(CLEAR);  // Clear the screen
-            printf("\n" BOLD CYAN " Vous avez atteint le portail!" RESET "\n");
-            printf("What would you like to do?\n");
-            printf("1. Enter the boss arena\n");
-            printf("2. Continue exploring the current map\n");
-            printf("\nYour choice (1 or 2): ");
-            
-            char choice = _getch();  // Get user input
-            if (choice == '1') {
-                player->readyForBoss = 1;  // Ready for boss battle
-                return;
+static int snapshotConfigValid(const GameConfig* config) {
+    return (config->mapSize == SMALL_MAP || config->mapSize == BIG_MAP || config->mapSize == CUSTOM_MAP) &&
+           config->enemyTurnTicks > 0 && config->tickRateHz > 0 && config->projectileSpeed > 0 &&
+           config->chaseRadius >= 0 && config->chaseRadius <= MAX_MAP_SIZE &&
+           config->crocodileCount >= 0 && config->crocodileCount <= MAX_CROCODILES &&
+           config->snakeCount >= 0 && config->snakeCount <= MAX_SNAKES;
+}
+
+static int snapshotSpawnsValid(const MapSpawns* spawns, int cellCount) {
+    if (!snapshotCell(spawns->player, cellCount, 1) || !snapshotCell(spawns->boss, cellCount, 1) ||
+        spawns->crocodileCount < 0 || spawns->crocodileCount > MAX_CROCODILES ||
+        spawns->snakeCount < 0 || spawns->snakeCount > MAX_SNAKES) return 0;
+    for (int i = 0; i < spawns->crocodileCount; i++) {
+        if (!snapshotCell(spawns->crocodiles[i], cellCount, 0)) return 0;
+    }
+    for (int i = 0; i < spawns->snakeCount; i++) {
+        if (!snapshotCell(spawns->snakes[i], cellCount, 0)) return 0;
+    }
+    return 1;
+}
+
+// Whether the cells of a chunk on the map hold real cell types and, once the
+// rays are in use, whether every stored free run stays on the map, as
+// projectiles follow them blindly
+static int snapshotChunkValid(const unsigned char* chunk, int top, int left, int rows, int cols, int rays) {
+    const unsigned char* types = chunk + offsetof(GridChunk, types);
+    const unsigned char* runs = chunk + offsetof(GridChunk, rays);
+
+    for (int i = 0; i < CHUNK_SIZE && top + i < rows; i++) {
+        for (int j = 0; j < CHUNK_SIZE && left + j < cols; j++) {
+            if (types[chunkOffset(i, j)] > CHECKPOINT) return 0;
+            for (int d = 0; rays && d < RAY_DIRECTIONS; d++) {
+                int run = runs[d * CHUNK_CELLS + chunkOffset(i, j)];
+                int row = top + i + run * rayDeltas[d][0], col = left + j + run * rayDeltas[d][1];
+                if (run > RAY_LIMIT || row < 0 || row >= rows || col < 0 || col >= cols) return 0;
             }
         }
     }
+    return 1;
 }
 
+// Rebuild a session from a snapshot, reusing the game's own grid and flow
+// field storage. A built-in map comes back as its config; a custom map's
+// text is not saved, so the game keeps the mapData it already had.
+// Returns 0, leaving the game untouched, if the snapshot is not valid:
+// every cell index, ring position, divisor and array index it holds is
+// checked first.
+int loadSnapshot(GameState* game, const unsigned char* data, size_t length) {
+    const unsigned char* cursor = data;
+    const unsigned char* end = data + length;
+    SnapshotHeader header;
+    Player player;
+    GameConfig config;
+    Crocodile crocodiles[MAX_CROCODILES];
+    Snake snakes[MAX_SNAKES];
+    Boss boss;
+    MapSpawns spawns;
+    int activeCrocodiles, activeSnakes, projectileCount;
+    int gridSize[4];
+
+    if (!snapshotTake(&cursor, end, &header, sizeof(header))) return 0;
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, 4) != 0 || header.version != SNAPSHOT_VERSION ||
+        header.layout != snapshotLayout() || header.length != length) return 0;
+
+    // Everything is read into locals and checked before the game is touched
+    if (!snapshotTake(&cursor, end, &player, sizeof(Player)) ||
+        !snapshotTake(&cursor, end, &config, sizeof(GameConfig)) ||
+        !snapshotTake(&cursor, end, crocodiles, sizeof(crocodiles)) ||
+        !snapshotTake(&cursor, end, &activeCrocodiles, sizeof(int)) ||
+        !snapshotTake(&cursor, end, snakes, sizeof(snakes)) ||
+        !snapshotTake(&cursor, end, &activeSnakes, sizeof(int)) ||
+        !snapshotTake(&cursor, end, &boss, sizeof(Boss)) ||
+        !snapshotTake(&cursor, end, &projectileCount, sizeof(int))) return 0;
+    if (activeCrocodiles < 0 || activeCrocodiles > MAX_CROCODILES || activeSnakes < 0 || activeSnakes > MAX_SNAKES ||
+        projectileCount < 0 || projectileCount > MAX_PROJECTILES) return 0;
+    const unsigned char* projectiles = cursor;
+    size_t skipped = (size_t)projectileCount * sizeof(Projectile) + sizeof(game->tickCount) + sizeof(game->rng.state);
+    if ((size_t)(end - cursor) < skipped) return 0;
+    cursor += skipped;
+    if (!snapshotTake(&cursor, end, gridSize, sizeof(gridSize)) ||
+        !snapshotTake(&cursor, end, &spawns, sizeof(MapSpawns))) return 0;
+    if (gridSize[0] < 1 || gridSize[0] > MAX_MAP_SIZE || gridSize[1] < 1 || gridSize[1] > MAX_MAP_SIZE) return 0;
+
+    Grid shape;
+    shape.chunkRows = (gridSize[0] + CHUNK_SIZE - 1) >> CHUNK_SHIFT;
+    shape.chunkCols = (gridSize[1] + CHUNK_SIZE - 1) >> CHUNK_SHIFT;
+    int chunks = shape.chunkRows * shape.chunkCols;
+    int cellCount = gridSize[0] * gridSize[1];
+    size_t blockBytes = gridDirectoryBytes(&shape) + (size_t)gridSize[2] * sizeof(GridChunk);
+    if (gridSize[2] < 0 || gridSize[2] > chunks || (size_t)(end - cursor) != blockBytes) return 0;
+    const unsigned char* directory = cursor;
+    for (int chunk = 0; chunk < chunks; chunk++) {
+        int slot;
+        memcpy(&slot, directory + (size_t)chunk * sizeof(int), sizeof(int));
+        if (slot == EMPTY_CHUNK) continue;
+        if (slot < 0 || slot >= gridSize[2]) return 0;
+        const unsigned char* stored = directory + gridDirectoryBytes(&shape) + (size_t)slot * sizeof(GridChunk);
+        if (!snapshotChunkValid(stored, (chunk / shape.chunkCols) << CHUNK_SHIFT,
+                                (chunk % shape.chunkCols) << CHUNK_SHIFT, gridSize[0], gridSize[1], gridSize[3])) return 0;
+    }
 
+    if (!snapshotPlayerValid(&player, cellCount) || !snapshotConfigValid(&config) ||
+        !snapshotSpawnsValid(&spawns, cellCount) || !snapshotCell(boss.position, cellCount, !boss.isActive)) return 0;
+    for (int i = 0; i < activeCrocodiles; i++) {
+        const Queue* patrol = &crocodiles[i].movementQueue;
+        if (!snapshotCell(crocodiles[i].position, cellCount, 1) || patrol->front < 0 ||
+            patrol->front >= PATROL_LENGTH || patrol->count < 0 || patrol->count > PATROL_LENGTH) return 0;
+        for (int j = 0; j < patrol->count; j++) {
+            if (!snapshotCell(patrol->cells[(patrol->front + j) % PATROL_LENGTH], cellCount, 1)) return 0;
+        }
+    }
+    for (int i = 0; i < activeSnakes; i++) {
+        if (!snapshotCell(snakes[i].position, cellCount, 1)) return 0;
+    }
+    for (int i = 0; i < projectileCount; i++) {
+        Projectile projectile;
+        memcpy(&projectile, projectiles + (size_t)i * sizeof(Projectile), sizeof(Projectile));
+        if (!snapshotCell(projectile.cell, cellCount, 0) || projectile.dRow < -1 || projectile.dRow > 1 ||
+            projectile.dCol < -1 || projectile.dCol > 1 ||
+            (projectile.owner != OWNER_PLAYER && projectile.owner != OWNER_SNAKE && projectile.owner != OWNER_BOSS)) {
+            return 0;
+        }
+    }
 
-      if (boss.isActive) printf("HP: %d | Boss HP: %d\n", player->health, boss.health);  // Display player and boss health
-      printf("[z] Up, [s] Down, [q] Left, [d] Right, [f] Shoot, [i] Inventory\n");
-      printf("[u] Use health pack, [c] Break thorns, [x] Quit, [r] Return to checkpoint\n");
-
-     input = _getch();  // Wait for user input
-    switch (input) {
-    case 'x': 
-        return;  // Quit the game
-    case 'f': {
-        printf("Shoot direction? [z] Up, [s] Down, [q] Left, [d] Right\n");
-        char shootDirection = _getch();  // Get shoot direction
-        shootBullet(player, graph, shootDirection);  // Shoot bullet
-        break;
-    }
-     case 'i':
-        displayInventory(player);  // Display inventory
-        break;
-     case 'u':
-        useHealthPack(player);  // Use health pack
-        break;
-     case 'c': {
-        printf("Thorn direction? [z] Up, [s] Down, [q] Left, [d] Right\n");
-        char breakDirection = _getch();  // Get thorn breaking direction
-        breakThorns(player, graph, breakDirection);  // Break thorns
-        break;
-    }
-    case 'r':
-        returnToLastCheckpoint(player);  // Return to last checkpoint
-        break;
-    default:
-        movePlayer(player, input, graph);  // Move player
-        break;
-}
-
-dangerWarning(player, graph);  // Display danger warning
-usleep(200000);  // Wait for a short period
- }
-}
-void addHighScore(const char *name, int score) {
-    // Create a new node for the score
-    HighScoreNode *newNode = (HighScoreNode*)malloc(sizeof(HighScoreNode));
-    strcpy(newNode->name, name);
-    newNode->score = score;
-    newNode->next = NULL;
-
-    // Insert at the head if necessary
-    if (head == NULL || head->score < score) {
-        newNode->next = head;
-        head = newNode;
-    } else {
-        // Find the correct position for the new score
-        HighScoreNode *current = head;
-        while (current->next != NULL && current->next->score >= score) {
-            current = current->next;
+    // Then the session is copied in
+    const char* mapData = game->config.mapData;
+    game->player = player;
+    game->config = config;
+    if (config.mapSize == SMALL_MAP) game->config.mapData = smallMap;
+    else if (config.mapSize == BIG_MAP) game->config.mapData = bigMap;
+    else game->config.mapData = mapData;
+
+    memcpy(game->crocodiles, crocodiles, sizeof(crocodiles));
+    game->activeCrocodiles = activeCrocodiles;
+    memcpy(game->snakes, snakes, sizeof(snakes));
+    game->activeSnakes = activeSnakes;
+    game->boss = boss;
+    game->projectiles.count = projectileCount;
+    cursor = projectiles;
+    snapshotTake(&cursor, end, game->projectiles.items, (size_t)projectileCount * sizeof(Projectile));
+    snapshotTake(&cursor, end, &game->tickCount, sizeof(game->tickCount));
+    snapshotTake(&cursor, end, &game->rng.state, sizeof(game->rng.state));
+
+    Grid* grid = &game->grid;
+    grid->rows = gridSize[0];
+    grid->cols = gridSize[1];
+    grid->cellCount = cellCount;
+    grid->chunkRows = shape.chunkRows;
+    grid->chunkCols = shape.chunkCols;
+    grid->raysReady = gridSize[3];
+    grid->terrainVersion++;  // Anything derived from the previous map is stale
+    grid->spawns = spawns;
+    grid->chunkCount = 0;
+    gridReserveChunks(grid, gridSize[2] > grid->chunkCapacity ? gridSize[2] : grid->chunkCapacity);
+    memcpy(grid->block, directory, blockBytes);
+    grid->chunkCount = gridSize[2];
+
+    reserveFlowField(&game->flowField, game->config.chaseRadius);
+    game->flowField.target = NO_CELL;
+    if (grid->journal != NULL) clearRewindJournal(grid->journal);
+    return 1;
+}
+
+// Parts of GameState a tick can change besides the grid, as byte ranges.
+// The flow field is a cache and the config never changes during a tick.
+// The whole projectile pool is included: a slot can come alive and die
+// again within one tick, and its old contents must still come back.
+static const int journalRanges[][2] = {
+    {offsetof(GameState, player), offsetof(GameState, config)},
+    {offsetof(GameState, crocodiles), offsetof(GameState, flowField)},
+    {offsetof(GameState, tickCount), sizeof(GameState)}
+};
+#define JOURNAL_RANGES (int)(sizeof(journalRanges) / sizeof(journalRanges[0]))
+#define JOURNAL_BLOCK 64        // Bytes compared at once before looking for the changed words
+
+void initRewindJournal(RewindJournal* journal, int ticks, int entries) {
+    memset(journal, 0, sizeof(*journal));
+    journal->tickCapacity = ticks > 0 ? ticks : 1;
+    journal->entryCapacity = entries > 0 ? entries : 1;
+    journal->tickSizes = (int*)malloc(journal->tickCapacity * sizeof(int));
+    journal->entries = (JournalEntry*)malloc(journal->entryCapacity * sizeof(JournalEntry));
+    journal->before = (unsigned char*)malloc(sizeof(GameState));
+}
+
+void clearRewindJournal(RewindJournal* journal) {
+    journal->entryStart = 0;
+    journal->entryCount = 0;
+    journal->tickStart = 0;
+    journal->tickCount = 0;
+    journal->openEntries = 0;
+    journal->overflowed = 0;
+}
+
+void cleanupRewindJournal(RewindJournal* journal) {
+    free(journal->tickSizes);
+    free(journal->entries);
+    free(journal->before);
+    memset(journal, 0, sizeof(*journal));
+}
+
+static void journalDropOldestTick(RewindJournal* journal) {
+    int size = journal->tickSizes[journal->tickStart];
+    journal->entryStart = (journal->entryStart + size) % journal->entryCapacity;
+    journal->entryCount -= size;
+    journal->tickStart = (journal->tickStart + 1) % journal->tickCapacity;
+    journal->tickCount--;
+}
+
+static void journalRecord(RewindJournal* journal, JournalKind kind, int where, int value) {
+    if (!journal->recording || journal->overflowed) return;
+
+    // Make room by forgetting old ticks; a tick that fills the ring alone is lost
+    while (journal->entryCount == journal->entryCapacity && journal->tickCount > 0) journalDropOldestTick(journal);
+    if (journal->entryCount == journal->entryCapacity) {
+        journal->overflowed = 1;
+        return;
+    }
+
+    JournalEntry* entry = &journal->entries[(journal->entryStart + journal->entryCount) % journal->entryCapacity];
+    entry->kind = kind;
+    entry->where = where;
+    entry->value = value;
+    journal->entryCount++;
+    journal->openEntries++;
+}
+
+static void journalBeginTick(RewindJournal* journal, const GameState* game) {
+    for (int i = 0; i < JOURNAL_RANGES; i++) {
+        int start = journalRanges[i][0];
+        memcpy(journal->before + start, (const char*)game + start, journalRanges[i][1] - start);
+    }
+    journal->openEntries = 0;
+    journal->overflowed = 0;
+    journal->recording = 1;
+}
+
+// Log the GameState words the tick changed and close it. Most of the state
+// is untouched by a tick, so whole blocks are compared first.
+static void journalEndTick(RewindJournal* journal, const GameState* game) {
+    const unsigned char* now = (const unsigned char*)game;
+
+    for (int i = 0; i < JOURNAL_RANGES; i++) {
+        for (int block = journalRanges[i][0]; block < journalRanges[i][1]; block += JOURNAL_BLOCK) {
+            int end = block + JOURNAL_BLOCK < journalRanges[i][1] ? block + JOURNAL_BLOCK : journalRanges[i][1];
+            if (memcmp(journal->before + block, now + block, end - block) == 0) continue;
+
+            for (int offset = block; offset < end; offset += sizeof(int)) {
+                int before, after;
+                memcpy(&before, journal->before + offset, sizeof(int));
+                memcpy(&after, now + offset, sizeof(int));
+                if (before != after) journalRecord(journal, JOURNAL_FIELD, offset, before);
+            }
         }
-        newNode->next = current->next;
-        current->next = newNode;
     }
+    journal->recording = 0;
+
+    if (journal->overflowed) {
+        clearRewindJournal(journal);
+        return;
+    }
+    if (journal->tickCount == journal->tickCapacity) journalDropOldestTick(journal);
+    journal->tickSizes[(journal->tickStart + journal->tickCount) % journal->tickCapacity] = journal->openEntries;
+    journal->tickCount++;
 }
 
-void displayHighScores() {
-    system(CLEAR);  // Clear the screen
-    printf("\n" BOLD " HIGH SCORES " RESET "\n\n");  // Display title in bold
+// Undo the most recent recorded tick, newest change first.
+// Returns 0 when the journal has no tick left to undo.
+int rewindTick(GameState* game) {
+    RewindJournal* journal = game->grid.journal;
+    if (journal == NULL || journal->tickCount == 0) return 0;
+
+    int last = (journal->tickStart + journal->tickCount - 1) % journal->tickCapacity;
+    int size = journal->tickSizes[last];
+    for (int i = journal->entryCount - 1; i >= journal->entryCount - size; i--) {
+        const JournalEntry* entry = &journal->entries[(journal->entryStart + i) % journal->entryCapacity];
+        switch (entry->kind) {
+            case JOURNAL_CELL_TYPE: gridSetType(&game->grid, entry->where, (CellType)entry->value); break;
+            case JOURNAL_CELL_HEALTH: gridSetHealth(&game->grid, entry->where, entry->value); break;
+            default: memcpy((char*)game + entry->where, &entry->value, sizeof(int)); break;
+        }
+    }
+    journal->entryCount -= size;
+    journal->tickCount--;
+    return 1;
+}
+
+static void highScoreLock(HighScoreStore* store, int exclusive) {
+#ifndef _WIN32
+    if (store->fd >= 0) flock(store->fd, exclusive ? LOCK_EX : LOCK_SH);
+#else
+    (void)store; (void)exclusive;
+#endif
+}
+
+static void highScoreUnlock(HighScoreStore* store) {
+#ifndef _WIN32
+    if (store->fd >= 0) flock(store->fd, LOCK_UN);
+#else
+    (void)store;
+#endif
+}
+
+static void initHighScoreFile(HighScoreFile* file) {
+    memset(file, 0, sizeof(*file));
+    file->magic = HIGH_SCORE_MAGIC;
+    file->version = HIGH_SCORE_VERSION;
+    file->capacity = HIGH_SCORE_CAPACITY;
+}
+
+// Map the score file shared, so scores from every running game land in it.
+// Without a usable file the scores are only kept for this process.
+void openHighScores(HighScoreStore* store) {
+    store->file = NULL;
+    store->fd = -1;
+#ifndef _WIN32
+    const char* path = getenv("CROCS_SCORES_FILE");
+    if (path == NULL || *path == '\0') path = HIGH_SCORE_FILE;
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd >= 0) {
+        struct stat info;
+        void* mapped = MAP_FAILED;
+
+        flock(fd, LOCK_EX);  // Another game may be creating the file right now
+        if (fstat(fd, &info) == 0 &&
+            ((size_t)info.st_size >= sizeof(HighScoreFile) || ftruncate(fd, sizeof(HighScoreFile)) == 0)) {
+            mapped = mmap(NULL, sizeof(HighScoreFile), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (mapped != MAP_FAILED) {
+            store->file = (HighScoreFile*)mapped;
+            store->fd = fd;
+            if (store->file->magic != HIGH_SCORE_MAGIC || store->file->version != HIGH_SCORE_VERSION ||
+                store->file->capacity != HIGH_SCORE_CAPACITY ||
+                store->file->count < 0 || store->file->count > HIGH_SCORE_CAPACITY) {
+                initHighScoreFile(store->file);  // New or unreadable file
+            }
+        }
+        flock(fd, LOCK_UN);
+        if (store->fd < 0) close(fd);
+    }
+#endif
+    if (store->file == NULL) {
+        store->file = (HighScoreFile*)malloc(sizeof(HighScoreFile));
+        initHighScoreFile(store->file);
+    }
+}
 
-    HighScoreNode *current = head;  // Start from the head of the list
-    int rank = 1;  // Initialize rank to 1
+void closeHighScores(HighScoreStore* store) {
+#ifndef _WIN32
+    if (store->fd >= 0) {
+        munmap(store->file, sizeof(HighScoreFile));
+        close(store->fd);
+        store->file = NULL;
+        store->fd = -1;
+    }
+#endif
+    free(store->file);  // Only the in-memory fallback is still set here
+    store->file = NULL;
+}
+
+static void swapEntries(HighScoreEntry* a, HighScoreEntry* b) {
+    HighScoreEntry temp = *a;
+    *a = *b;
+    *b = temp;
+}
 
-    // Display top 10 scores
-    while (current != NULL && rank <= 10) {
-        printf("%d. %s: %d\n", rank, current->name, current->score);  // Print rank, name, and score
-        current = current->next;  // Move to next node
-        rank++;  // Increment rank
+// Keep the score if it makes the top HIGH_SCORE_CAPACITY, in O(log K)
+void addHighScore(HighScoreStore* store, const char *name, int score) {
+    HighScoreFile* file = store->file;
+    HighScoreEntry entry;
+
+    memset(&entry, 0, sizeof(entry));
+    strncpy(entry.name, name, MAX_NAME_LENGTH - 1);
+    entry.score = score;
+
+    highScoreLock(store, 1);
+    if (file->count < HIGH_SCORE_CAPACITY) {
+        // Room left: add at the bottom and sift up
+        int i = file->count++;
+        file->entries[i] = entry;
+        while (i > 0 && file->entries[(i - 1) / 2].score > file->entries[i].score) {
+            swapEntries(&file->entries[(i - 1) / 2], &file->entries[i]);
+            i = (i - 1) / 2;
+        }
+    } else if (score > file->entries[0].score) {
+        // Full: the new score replaces the lowest one and sifts down
+        int i = 0;
+        file->entries[0] = entry;
+        while (1) {
+            int smallest = i, left = 2 * i + 1, right = 2 * i + 2;
+            if (left < file->count && file->entries[left].score < file->entries[smallest].score) smallest = left;
+            if (right < file->count && file->entries[right].score < file->entries[smallest].score) smallest = right;
+            if (smallest == i) break;
+            swapEntries(&file->entries[i], &file->entries[smallest]);
+            i = smallest;
+        }
+    }
+    highScoreUnlock(store);
+}
+
+static int compareScoresDescending(const void* a, const void* b) {
+    return ((const HighScoreEntry*)b)->score - ((const HighScoreEntry*)a)->score;
+}
+
+void displayHighScores(HighScoreStore* store) {
+    HighScoreEntry ranking[HIGH_SCORE_CAPACITY];
+    int count;
+
+    // Copy the heap out under the lock, then order it for display
+    highScoreLock(store, 0);
+    count = store->file->count;
+    memcpy(ranking, store->file->entries, count * sizeof(HighScoreEntry));
+    highScoreUnlock(store);
+    qsort(ranking, count, sizeof(HighScoreEntry), compareScoresDescending);
+
+    clearScreen();  // Clear the screen
+    printf("\n" BOLD " HIGH SCORES " RESET "\n\n");  // Display title in bold
+
+    for (int rank = 1; rank <= count; rank++) {
+        printf("%d. %s: %d\n", rank, ranking[rank - 1].name, ranking[rank - 1].score);  // Print rank, name, and score
     }
 
     printf("\nPress any key to continue...\n");  // Prompt user to continue
@@ -1452,7 +2960,7 @@ void displayHighScores() {
 
 
 int playAgain() {
-    system(CLEAR);  // Clear screen
+    clearScreen();  // Clear screen
     printf("\nDo you want to play again? (y/n): ");  // Ask
     char choice = _getch();  // Get input
     return (choice == 'o' || choice == 'O');  // Return true for 'o' or 'O'
@@ -1460,61 +2968,95 @@ int playAgain() {
 
 
 
-int main() {
+#ifndef CROCS_NO_MAIN
+int main(int argc, char* argv[]) {
     char playerName[MAX_NAME_LENGTH];
     int continueGame = 1;
+    static GameState game;  // Its grid is allocated by the first game and reused by every restart
+    HighScoreStore highScores;
+    char* customMap = NULL;
+    const char* recordPath = NULL;
+    ReplayWriter recorder = {NULL, 0};
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--replay") == 0) {
+            // Re-check recorded sessions headless, then exit
+            int failures = 0;
+            for (i++; i < argc; i++) {
+                if (!replaySession(&game, argv[i])) failures++;
+            }
+            cleanupGame(&game);
+            return failures > 0;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];  // Each new game overwrites the recording
+        } else {
+            // An optional map file replaces the built-in map, at whatever size it has
+            customMap = loadMapFile(argv[i]);
+            if (customMap == NULL) {
+                printf("Cannot load map %s (at most %dx%d cells)\n", argv[i], MAX_MAP_SIZE, MAX_MAP_SIZE);
+                return 1;
+            }
+        }
+    }
+
+    openHighScores(&highScores);  // Scores from earlier games are there straight away
 
     while (continueGame) {
-        system(CLEAR);  // Clear screen
+        clearScreen();  // Clear screen
         printf("\n" BOLD " NEW GAME " RESET "\n\n");
         printf("Enter your name (max %d chars): ", MAX_NAME_LENGTH - 1);
         scanf("%s", playerName);  // Get player name
 
-        Node* graph[ROWS][COLS];
-        Player player;
-        strcpy(player.name, playerName);
+        strcpy(game.player.name, playerName);
 
         DifficultyNode* difficultyTree = buildDifficultyTree();  // Build difficulty tree
         GameConfig* gameConfig = getDifficultyChoices(difficultyTree);  // Get game config
+        if (customMap != NULL) {
+            gameConfig->mapSize = CUSTOM_MAP;
+            gameConfig->mapData = customMap;
+        }
+        gameConfig->seed = (unsigned long long)time(NULL);
 
-        initializeGame(graph, &player, gameConfig);  // Initialize game
+        resetGame(&game, gameConfig);  // Initialize game
+        if (recordPath != NULL && !replayBegin(&recorder, recordPath, gameConfig)) {
+            printf("Cannot record to %s\n", recordPath);
+        }
 
-        gameLoop(graph, &player);  // Main game loop
+        gameLoop(&game, &recorder);  // Main game loop
 
-        if (player.readyForBoss && player.health > 0) {  // Boss battle
-            system(CLEAR);
+        if (game.player.readyForBoss && game.player.health > 0) {  // Boss battle
+            clearScreen();
             printf("\n" BOLD YELLOW " Get ready for the final fight! " RESET "\n");
             _getch();  // Wait for input
-            initializeBoss(graph, &player, bossMap);  // Initialize boss
-            gameLoop(graph, &player);  // Continue game
+            if (!initializeBoss(&game, bossMap)) {  // Initialize boss
+                printf("Error: Boss position not found!\n");
+                exit(1);
+            }
+            gameLoop(&game, &recorder);  // Continue game
         }
+        replayEnd(&recorder, game.tickCount, hashGameState(&game));
 
-        addHighScore(player.name, player.score);  // Save score
+        addHighScore(&highScores, game.player.name, game.player.score);  // Save score
 
-        system(CLEAR);
+        clearScreen();
         printf("\n" BOLD " Game Over! " RESET "\n");
-        printf("Final score: %d\n\n", player.score);
+        printf("Final score: %d\n\n", game.player.score);
         printf("Press any key to view high scores...\n");
         _getch();  // Wait for input
-        displayHighScores();  // Show high scores
+        displayHighScores(&highScores);  // Show high scores
 
         // Cleanup resources
-        cleanupGraph(graph);
-        cleanupCrocodiles();
-        cleanupSnakes();
-        clearCheckpointStack(&player.checkpoints);
         freeDifficultyTree(difficultyTree);
         free(gameConfig);
 
         continueGame = playAgain();  // Ask to play again
     }
 
-    // Cleanup high scores list
-    while (head != NULL) {
-        HighScoreNode *temp = head;
-        head = head->next;
-        free(temp);  // Free high score nodes
-    }
+    cleanupGame(&game);
+    free(customMap);
+
+    closeHighScores(&highScores);
 
     return 0;
 }
+#endif
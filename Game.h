@@ -0,0 +1,649 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// Platform-specific includes
+#ifdef _WIN32
+    #include <conio.h>
+    #include <windows.h>
+    #include <mmsystem.h>
+    #define CLEAR "cls"
+#else
+    #include <termios.h>
+    #include <unistd.h>
+    #include <stdio.h>
+    #include <poll.h>
+    #include <pthread.h>
+    #include <fcntl.h>
+    #include <sys/ioctl.h>
+    #include <sys/mman.h>
+    #include <sys/file.h>
+    #include <sys/stat.h>
+    #define CLEAR "clear"
+
+    int _getch(void);
+#endif
+
+
+// Constants
+#define MAX_MAP_SIZE 4096       // Rows and columns a map may have at most
+#define CHUNK_SHIFT 4
+#define CHUNK_SIZE (1 << CHUNK_SHIFT)   // The grid is stored in 16x16 chunks
+#define CHUNK_CELLS (CHUNK_SIZE * CHUNK_SIZE)
+#define EMPTY_CHUNK -1
+#define MAX_CROCODILES 4
+#define MAX_SNAKES 2
+#define MAX_PROJECTILES 256
+#define PATROL_LENGTH 4         // Cells in a crocodile's patrol loop
+#define MAX_CHECKPOINTS 16      // Deepest checkpoint history a GameConfig may ask for
+#define THREAT_RADIUS 5         // Enemies this close (in rows and columns) count as a danger
+#define RAY_DIRECTIONS 8        // Up, down, left, right, then the four diagonals
+#define RAY_LIMIT 15            // Longest free run stored; longer ones are followed in steps of it
+#define SMALL_MAP 0
+#define BIG_MAP 1
+#define CUSTOM_MAP 2
+#define ENEMY_EASY 0
+#define ENEMY_HARD 1
+#define POWER_WEAK 0
+#define POWER_STRONG 1
+#define CROC_PATROL 0           // Crocodiles walk their patrol loop
+#define CROC_CHASE 1            // Crocodiles close in on a nearby player
+#define MAX_NAME_LENGTH 20
+#define MAX_MESSAGE_LENGTH 10
+#define NO_CELL -1
+#define SCREEN_WIDTH 80
+#define HUD_LINES 8
+#define KEY_NONE -1             // waitForKey timed out
+#define KEY_CLOSED -2           // Standard input was closed
+#define KEY_BUFFER_SIZE 16
+#define HIGH_SCORE_CAPACITY 10  // Scores kept on the leaderboard
+#define HIGH_SCORE_MAGIC 0x52435343u    // "CSCR"
+#define HIGH_SCORE_VERSION 1
+#define HIGH_SCORE_FILE "crocs_scores.dat"  // Overridden by CROCS_SCORES_FILE
+#define REPLAY_MAGIC "CRRP"
+#define REPLAY_VERSION 2
+#define REPLAY_END 0xFF         // Action byte closing the list of recorded actions
+#define SNAPSHOT_MAGIC "CRSS"
+#define SNAPSHOT_VERSION 1
+
+// ANSI Color codes
+#define RESET   "\x1b[0m"
+#define RED     "\x1b[31m"
+#define GREEN   "\x1b[32m"
+#define YELLOW  "\x1b[33m"
+#define BLUE    "\x1b[34m"
+#define MAGENTA "\x1b[35m"
+#define CYAN    "\x1b[36m"
+#define WHITE   "\x1b[37m"
+#define BOLD    "\x1b[1m"
+#define UNDERLINE "\x1b[4m"
+
+// Terminal control sequences used by the frame renderer
+#define ALT_SCREEN_ON  "\x1b[?1049h"
+#define ALT_SCREEN_OFF "\x1b[?1049l"
+#define CURSOR_HIDE    "\x1b[?25l"
+#define CURSOR_SHOW    "\x1b[?25h"
+#define CLEAR_SCREEN   "\x1b[2J\x1b[H"
+
+// Type definitions
+typedef enum {
+    SAFE_LAND,
+    THORNS,
+    WALL,
+    CROCODILE,
+    SNAKE,
+    FOOD,
+    GUN,
+    BULLET,
+    AXE,
+    HEALTH_PACK,
+    PORTAL,
+    BOSS,
+    CHECKPOINT
+} CellType;
+
+// Bitboard layers kept next to the cell types. A cell type belongs to
+// one or more layers (see cellLayers); every layer has one bit per cell.
+typedef enum {
+    LAYER_WALL,
+    LAYER_THORNS,
+    LAYER_ENEMY,        // Crocodiles, snakes and the boss
+    LAYER_PICKUP,       // Anything the player can pick up
+    LAYER_OCCUPIED,     // Anything but safe land
+    LAYER_COUNT
+} CellLayer;
+
+// Everything the player can carry. New kinds go before ITEM_KIND_COUNT,
+// with a row in itemTable and a display name in itemNames.
+typedef enum {
+    ITEM_BULLETS,
+    ITEM_AXE,
+    ITEM_FOOD,
+    ITEM_HEALTH_PACK,
+    ITEM_KIND_COUNT
+} ItemKind;
+
+#define NO_ITEM -1
+
+// Everything the player can do in one tick. Directional actions are grouped
+// as up, down, left, right so they can be built from a z/s/q/d key.
+typedef enum {
+    ACTION_NONE,
+    ACTION_MOVE_UP,
+    ACTION_MOVE_DOWN,
+    ACTION_MOVE_LEFT,
+    ACTION_MOVE_RIGHT,
+    ACTION_SHOOT_UP,
+    ACTION_SHOOT_DOWN,
+    ACTION_SHOOT_LEFT,
+    ACTION_SHOOT_RIGHT,
+    ACTION_BREAK_UP,
+    ACTION_BREAK_DOWN,
+    ACTION_BREAK_LEFT,
+    ACTION_BREAK_RIGHT,
+    ACTION_USE_HEALTH_PACK,
+    ACTION_RETURN_CHECKPOINT,
+    ACTION_ENTER_ARENA,
+    ACTION_QUIT
+} Action;
+
+// Where a session stands after a tick
+typedef enum {
+    GAME_RUNNING,
+    GAME_AT_PORTAL,      // Standing on the portal, the arena can be entered
+    GAME_ARENA_READY,    // Exploration is over, the boss arena comes next
+    GAME_PLAYER_DEAD,
+    GAME_BOSS_DEFEATED,
+    GAME_QUIT
+} GameStatus;
+
+// What last hurt the player, so a death can be put down to its cause
+typedef enum {
+    DAMAGE_NONE,
+    DAMAGE_CROCODILE,
+    DAMAGE_SNAKE,
+    DAMAGE_THORNS,
+    DAMAGE_BOSS,
+    DAMAGE_CAUSE_COUNT
+} DamageCause;
+
+// Forward declarations of structures
+typedef struct Grid Grid;
+typedef struct RewindJournal RewindJournal;
+typedef struct Queue Queue;
+typedef struct StackNode StackNode;
+typedef struct Stack Stack;
+typedef struct Player Player;
+typedef struct GameConfig GameConfig;
+typedef struct DifficultyNode DifficultyNode;
+typedef struct Snake Snake;
+typedef struct Crocodile Crocodile;
+
+// Structure definitions
+
+// One 16x16 block of cells, stored field by field
+typedef struct GridChunk {
+    unsigned char types[CHUNK_CELLS];   // CellType of every cell
+    short health[CHUNK_CELLS];          // Hit points of the enemy standing on the cell
+    short threats[CHUNK_CELLS];         // Enemies within THREAT_RADIUS of the cell
+    short threatRows[CHUNK_CELLS];      // Sum of the row offsets from the cell to those enemies
+    short threatCols[CHUNK_CELLS];      // Sum of the column offsets
+    unsigned short layers[LAYER_COUNT][CHUNK_SIZE];  // Per layer, one bit per column of every row
+    unsigned char rays[RAY_DIRECTIONS][CHUNK_CELLS]; // Safe-land cells in a row from the cell, per direction
+} GridChunk;
+
+// Spawn points found while parsing a map ('c' crocodile, 's' snake, 'B' boss)
+typedef struct MapSpawns {
+    int player;
+    int boss;
+    int crocodiles[MAX_CROCODILES];
+    int crocodileCount;
+    int snakes[MAX_SNAKES];
+    int snakeCount;
+} MapSpawns;
+
+// The map, sized when it is loaded. A cell is addressed by its index
+// (row * cols + col) and its neighbours are computed from it. Storage is
+// chunked: chunks that are only safe land are never allocated, so memory
+// follows what the map actually holds. The chunk directory and the chunks
+// share one block, which only grows when a write lands in an empty chunk.
+struct Grid {
+    int rows, cols;
+    int cellCount;
+    int chunkRows, chunkCols;
+    char *block;            // Chunk directory followed by the chunks themselves
+    size_t blockSize;
+    int *chunkIndex;        // Slot of every chunk in chunks, or EMPTY_CHUNK
+    GridChunk *chunks;
+    int chunkCount;
+    int chunkCapacity;
+    MapSpawns spawns;
+    unsigned long terrainVersion;   // Bumped whenever a cell starts or stops being walkable
+    int raysReady;                  // Chunk ray tables are built and kept up to date
+    RewindJournal* journal;         // Logs cell changes made by recorded ticks, NULL when off
+};
+
+// A built-in map, parsed once and copied into a session's grid whenever
+// a game or the arena starts on it. Never written after it is built.
+typedef struct MapTemplate {
+    const char* map;    // Text it was parsed from
+    Grid grid;
+} MapTemplate;
+
+// What picking up an item from the map does
+typedef struct ItemInfo {
+    CellType cell;              // Cell the item lies on in the map
+    int pickupAmount;           // Units added to the inventory
+    int healthBonus;            // Health gained on pickup
+    int armsPlayer;             // Picking it up gives the player a gun
+    const char* pickupMessage;
+} ItemInfo;
+
+// Fixed ring of patrol cells; a patrol never holds more than PATROL_LENGTH
+struct Queue {
+    int cells[PATROL_LENGTH];
+    int front;
+    int count;
+};
+
+// Player state saved when a checkpoint is reached
+typedef struct Checkpoint {
+    int position;
+    int health;
+    int score;
+    int inventory[ITEM_KIND_COUNT];
+    int hasGun;
+} Checkpoint;
+
+// Ring of the most recent checkpoints; once full, a new one replaces the oldest
+typedef struct CheckpointStack {
+    Checkpoint entries[MAX_CHECKPOINTS];
+    int top;    // Slot the next checkpoint goes into
+    int size;
+    int depth;  // Checkpoints kept, at most MAX_CHECKPOINTS
+} CheckpointStack;
+
+struct Player {
+    char name[20];
+    int position;
+    int health;
+    int score;
+    int inventory[ITEM_KIND_COUNT];  // Units held of every item kind
+    int hasGun;
+    char message[100];
+    int readyForBoss;
+    int hasQuit;
+    DamageCause lastDamage;
+    CheckpointStack checkpoints;  // New field for checkpoint stack
+};
+typedef struct Boss {
+    int position;
+    int health;
+    int attackCooldown;
+    int phaseNumber;  // For different attack patterns
+    int isActive;
+    int moveCooldown;
+} Boss;
+
+struct GameConfig {
+    int mapSize;
+    int enemyCount;
+    int enemyPower;
+    const char* mapData;
+    int snakeHealth;
+    int crocodileHealth;
+    int snakeDamage;
+    int crocodileDamage;
+    int snakeCount;
+    int crocodileCount;
+    int projectileSpeed;    // Cells a projectile covers per tick
+    int tickRateHz;         // Simulation ticks per second in the interactive loop
+    int enemyTurnTicks;     // Enemies act once every this many ticks
+    int crocodileBehavior;  // CROC_PATROL or CROC_CHASE
+    int chaseRadius;        // How far from the player crocodiles pick up the trail
+    int checkpointDepth;    // Checkpoints the player can go back through
+    unsigned long long seed;    // Seeds the game's random number generator
+};
+
+struct DifficultyNode {
+    char* prompt;
+    DifficultyNode* left;
+    DifficultyNode* right;
+    int level;
+};
+
+struct Snake {
+    int position;
+    int health;
+    int shootCooldown;
+};
+
+struct Crocodile {
+    int position;
+    Queue movementQueue;
+};
+
+// Walking distances to the player over a square window centred on the player.
+// The buffers are allocated once and shared by every crocodile, and the field is
+// only rebuilt when the player moves or the walkable terrain changes.
+typedef struct FlowField {
+    int radius;
+    int size;               // 2 * radius + 1 cells per side
+    int top, left;          // Grid row and column of the window's first cell
+    int target;             // Cell the distances lead to, NO_CELL if not built
+    unsigned long terrainVersion;
+    int* distance;          // size * size steps to the target, -1 if unreachable
+    int* frontier;          // BFS queue, size * size entries
+} FlowField;
+
+// xorshift64* generator; every game seeds its own from GameConfig.seed
+typedef struct GameRng {
+    unsigned long long state;
+} GameRng;
+
+// Records a session as its config, map and the actions taken, each with the
+// number of ticks since the previous one
+typedef struct ReplayWriter {
+    FILE* file;
+    unsigned long lastTick;
+} ReplayWriter;
+
+// Start of a session snapshot. The body is raw copies of the game's
+// structures, so a snapshot is only read back by the build that wrote it.
+typedef struct SnapshotHeader {
+    char magic[4];
+    unsigned int version;
+    unsigned int layout;    // Fingerprint of the structure sizes the body depends on
+    unsigned int length;    // Bytes in the whole snapshot, header included
+} SnapshotHeader;
+
+typedef enum {
+    OWNER_PLAYER,
+    OWNER_SNAKE,
+    OWNER_BOSS
+} ProjectileOwner;
+
+// A bullet in flight, moved a fixed number of cells every tick
+typedef struct Projectile {
+    int cell;
+    int dRow, dCol;
+    ProjectileOwner owner;
+    int damage;             // Damage dealt to the player by enemy projectiles
+} Projectile;
+
+// Live projectiles are kept packed at the front so a tick only visits those
+typedef struct ProjectilePool {
+    Projectile items[MAX_PROJECTILES];
+    int count;
+} ProjectilePool;
+
+// Colour of a screen cell; each style maps to one full SGR sequence
+typedef enum {
+    STYLE_PLAIN,
+    STYLE_RED,
+    STYLE_YELLOW,
+    STYLE_GREEN,
+    STYLE_BLUE,
+    STYLE_MAGENTA,
+    STYLE_CYAN,
+    STYLE_WHITE,
+    STYLE_BOLD_GREEN,
+    STYLE_BOLD_CYAN,
+    STYLE_BOLD_RED
+} CellStyle;
+
+typedef struct ScreenCell {
+    char glyph;
+    unsigned char style;
+} ScreenCell;
+
+// Double-buffered terminal: frames are composed in back, compared with
+// front (what the terminal already shows) and only the differences are sent
+typedef struct Renderer {
+    int width, height;
+    ScreenCell* front;
+    ScreenCell* back;
+    char* out;              // Escape sequences for one frame, sent with a single write
+    size_t outLength;
+    size_t outCapacity;
+    int fd;
+    void (*sink)(void* context, const char* data, size_t length);  // Gets the bytes instead of fd when set
+    void* sinkContext;
+    int active;
+    char prompt[2][SCREEN_WIDTH + 1];  // Two-line question shown under the HUD
+} Renderer;
+
+// Keys typed but not played yet, for the front-ends that read a key stream
+typedef struct KeyInput {
+    int keys[KEY_BUFFER_SIZE];
+    int count;
+    char pendingKey;        // First key of a two-key action, 0 if none
+    int portalPrompt;       // The arena offer is on screen
+} KeyInput;
+typedef struct HighScoreEntry {
+    char name[MAX_NAME_LENGTH];
+    int score;
+} HighScoreEntry;
+
+// Layout of the high-score file, mapped as is. The entries form a min-heap
+// on score, so the lowest kept score is always entries[0].
+typedef struct HighScoreFile {
+    unsigned int magic;
+    unsigned int version;
+    int capacity;
+    int count;
+    HighScoreEntry entries[HIGH_SCORE_CAPACITY];
+} HighScoreFile;
+
+typedef struct HighScoreStore {
+    HighScoreFile* file;
+    int fd;                 // Locked around every access, -1 when only kept in memory
+} HighScoreStore;
+
+
+// Everything one game session owns. Sessions share nothing, so a process
+// can hold as many as it likes; the map text in config must outlive the game.
+typedef struct GameState {
+    Grid grid;
+    Player player;
+    GameConfig config;
+    Crocodile crocodiles[MAX_CROCODILES];
+    int activeCrocodiles;
+    Snake snakes[MAX_SNAKES];
+    int activeSnakes;
+    Boss boss;
+    ProjectilePool projectiles;
+    FlowField flowField;
+    unsigned long tickCount;    // Ticks simulated since the game started, arena included
+    GameRng rng;
+} GameState;
+
+// What a journal entry restores
+typedef enum {
+    JOURNAL_CELL_TYPE,      // where is a cell, value its previous CellType
+    JOURNAL_CELL_HEALTH,    // where is a cell, value its previous health
+    JOURNAL_FIELD           // where is a byte offset into GameState, value the int there before
+} JournalKind;
+
+typedef struct JournalEntry {
+    int kind;
+    int where;
+    int value;
+} JournalEntry;
+
+// Undo log of the last ticks. Every recorded tick adds the cells it changed
+// and the GameState words that differ after it, so memory follows how much
+// changes rather than the map size. Both rings are bounded: once either is
+// full the oldest ticks are forgotten. A game records into a journal once
+// its grid.journal points at it; loading a map or a snapshot empties it.
+struct RewindJournal {
+    JournalEntry* entries;  // Ring of changes, oldest tick first
+    int entryCapacity;
+    int entryStart;
+    int entryCount;
+    int* tickSizes;         // Ring of the entries each recorded tick added
+    int tickCapacity;
+    int tickStart;
+    int tickCount;
+    int openEntries;        // Entries of the tick being recorded
+    int recording;          // A tick is being recorded
+    int overflowed;         // The open tick outgrew the ring and can't be undone
+    unsigned char* before;  // GameState as it was when the open tick started
+};
+
+// Function prototypes
+// Grid management
+void initGraphFromMap(Grid* grid, Player *player, const char* map);
+void cleanupGraph(Grid* grid);
+int measureMap(const char* map, int* rows, int* cols);
+char* loadMapFile(const char* path);
+CellType gridType(const Grid* grid, int cell);
+CellType gridTypeAt(const Grid* grid, int row, int col);
+void gridSetType(Grid* grid, int cell, CellType type);
+int gridHealth(const Grid* grid, int cell);
+int threatCount(const Grid* grid, int cell);
+void threatDirection(const Grid* grid, int cell, int* dRow, int* dCol);
+int gridHasLayer(const Grid* grid, int cell, CellLayer layer);
+int gridAnyWithin(const Grid* grid, int cell, int radius, CellLayer layer);
+int rayDirection(int dRow, int dCol);
+int rayLength(const Grid* grid, int cell, int direction);
+void gridSetHealth(Grid* grid, int cell, int health);
+int cellIndex(const Grid* grid, int row, int col);
+int cellRow(const Grid* grid, int cell);
+int cellCol(const Grid* grid, int cell);
+int cellNeighbor(const Grid* grid, int cell, char direction);
+void directionDelta(char direction, int* dRow, int* dCol);
+
+// Queue operations
+void initQueue(Queue *queue);
+void enqueue(Queue *queue, int position);
+int dequeue(Queue *queue);
+
+// Stack operations
+void handleCheckpoint(GameState* game, int cell);
+void pushCheckpoint(CheckpointStack* stack, const Player* player);
+int popCheckpoint(CheckpointStack* stack, Checkpoint* checkpoint);
+int returnToLastCheckpoint(Player* player);
+void clearCheckpointStack(CheckpointStack* stack);
+
+// Inventory management
+int itemAtCell(CellType type);
+void addInventoryItem(Player *player, ItemKind kind);
+int removeInventoryItem(Player *player, ItemKind kind);
+void displayInventory(Renderer* renderer, Player *player);
+void useHealthPack(Player *player);
+
+// Player actions
+void movePlayer(GameState* game, char direction);
+void shootBullet(GameState* game, char direction);
+void breakThorns(GameState* game, char direction);
+
+// Enemy management
+void initCrocodiles(GameState* game);
+void setupCrocodiles(GameState* game);
+void moveAllCrocodiles(GameState* game);
+void reserveFlowField(FlowField* field, int radius);
+void updateFlowField(FlowField* field, Grid* grid, int target);
+int flowDistance(const FlowField* field, const Grid* grid, int cell);
+void cleanupFlowField(FlowField* field);
+void checkCrocodileAttack(GameState* game, int crocodileCell);
+void cleanupCrocodiles(GameState* game);
+int initializeBoss(GameState* game, const char* bossMap);
+void moveBoss(GameState* game);
+void bossAttackPattern(GameState* game);
+void shootAtPlayer(GameState* game);
+
+
+
+
+
+void initSnakes(GameState* game);
+void setupSnakes(GameState* game);
+void snakeShoot(GameState* game, Snake* snake);
+
+// Projectiles
+int spawnProjectile(ProjectilePool* pool, int cell, int dRow, int dCol, ProjectileOwner owner, int damage);
+void updateProjectiles(GameState* game);
+void clearProjectiles(ProjectilePool* pool);
+void hitEnemy(GameState* game, int cell);
+void handleAllSnakesShooting(GameState* game);
+void cleanupSnakes(GameState* game);
+
+// Game setup and control
+DifficultyNode* createDifficultyNode(char* prompt, int level);
+DifficultyNode* buildDifficultyTree(void);
+GameConfig* getDifficultyChoices(DifficultyNode* root);
+void configureGame(GameConfig* config, int mapSize, int enemyCount, int enemyPower);
+int configureGameFromLabel(GameConfig* config, const char* label);
+void freeDifficultyTree(DifficultyNode* root);
+void initializeGame(GameState* game, const GameConfig* config);
+void resetGame(GameState* game, const GameConfig* config);
+void cleanupGame(GameState* game);
+void gameLoop(GameState* game, ReplayWriter* recorder);
+void displayGraph(Renderer* renderer, GameState* game);
+void setPrompt(Renderer* renderer, const char* title, const char* question);
+void clearScreen(void);
+void terminalSize(int* rows, int* cols);
+
+// Terminal input
+void setRawMode(int enable);
+int waitForKey(int timeoutMs);
+long long monotonicMs(void);
+Action actionFromInput(Renderer* renderer, GameState* game, int key, char* pendingKey);
+void queueKey(KeyInput* input, int key);
+int showPortalPrompt(Renderer* renderer, GameStatus status, KeyInput* input);
+Action takeKeyAction(Renderer* renderer, GameState* game, KeyInput* input);
+
+// Determinism, replays and snapshots
+void seedRng(GameRng* rng, unsigned long long seed);
+unsigned int rngNext(GameRng* rng);
+unsigned long long hashGameState(GameState* game);
+int replayBegin(ReplayWriter* writer, const char* path, const GameConfig* config);
+void replayRecord(ReplayWriter* writer, unsigned long tick, Action action);
+void replayEnd(ReplayWriter* writer, unsigned long tick, unsigned long long stateHash);
+int replaySession(GameState* game, const char* path);
+void initRewindJournal(RewindJournal* journal, int ticks, int entries);
+void clearRewindJournal(RewindJournal* journal);
+void cleanupRewindJournal(RewindJournal* journal);
+int rewindTick(GameState* game);
+size_t snapshotSize(const GameState* game);
+size_t saveSnapshot(const GameState* game, unsigned char* buffer, size_t capacity);
+int loadSnapshot(GameState* game, const unsigned char* data, size_t length);
+
+// Frame renderer
+void rendererBegin(Renderer* renderer, int fd, int width, int height);
+void rendererEnd(Renderer* renderer);
+void rendererClear(Renderer* renderer);
+void rendererPutText(Renderer* renderer, int row, int col, const char* text, CellStyle style);
+void rendererPresent(Renderer* renderer);
+int dangerWarning(Player *player, Grid *grid);
+
+// Headless engine
+void gameStep(GameState* game, Action action);
+int playerTick(GameState* game, Action action);
+void enemyTurn(GameState* game);
+int enterArenaIfReady(GameState* game);
+void headlessStep(GameState* game, Action action);
+GameStatus gameStatus(GameState* game);
+int isGameDone(GameState* game);
+Action actionFromKey(char key);
+Action directionalAction(Action upAction, char direction);
+
+//HIGH Score
+void openHighScores(HighScoreStore* store);
+void closeHighScores(HighScoreStore* store);
+void addHighScore(HighScoreStore* store, const char *name, int score);
+void displayHighScores(HighScoreStore* store);
+
+// Built-in maps
+extern const char* smallMap;
+extern const char* bigMap;
+extern const char* bossMap;
+
+#endif
@@ -0,0 +1,203 @@
+// Benchmarks for the engine hot paths. Every benchmark runs a fixed number
+// of operations several times and the results are printed as JSON, so two
+// runs can be compared before and after a change:
+//
+//   crocs-bench [-r runs] [-f factor] > before.json
+//
+// malloc, calloc and realloc are wrapped at link time (see the
+// Makefile) so allocations made inside the timed loops are counted too.
+
+#include "Game.h"
+
+#define BENCH_DEFAULT_RUNS 5
+#define BENCH_MAX_RUNS 64
+
+// Allocation counters, bumped by the wrappers below
+static unsigned long long allocationCount;
+static unsigned long long allocatedBytes;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    allocationCount++;
+    allocatedBytes += size;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    allocationCount++;
+    allocatedBytes += count * size;
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    allocationCount++;
+    allocatedBytes += size;
+    return __real_realloc(pointer, size);
+}
+
+typedef struct BenchContext {
+    GameState* game;
+    GameConfig config;
+    Renderer renderer;
+    GameRng rng;
+} BenchContext;
+
+typedef struct Benchmark {
+    const char* name;
+    long iterations;
+    void (*setup)(BenchContext* context);
+    void (*run)(BenchContext* context, long iteration);
+} Benchmark;
+
+static long long nowNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// A fresh game on the big map, crocodiles chasing
+static void setupBigMap(BenchContext* context) {
+    configureGame(&context->config, BIG_MAP, ENEMY_HARD, POWER_STRONG);
+    context->config.seed = 42;
+    initializeGame(context->game, &context->config);
+    seedRng(&context->rng, 42);
+}
+
+static void setupSmallMap(BenchContext* context) {
+    configureGame(&context->config, SMALL_MAP, ENEMY_HARD, POWER_STRONG);
+    context->config.seed = 42;
+    initializeGame(context->game, &context->config);
+    seedRng(&context->rng, 42);
+}
+
+static void benchLoadSmallMap(BenchContext* context, long iteration) {
+    (void)iteration;
+    initGraphFromMap(&context->game->grid, &context->game->player, smallMap);
+}
+
+static void benchLoadBigMap(BenchContext* context, long iteration) {
+    (void)iteration;
+    initGraphFromMap(&context->game->grid, &context->game->player, bigMap);
+}
+
+// Walk back and forth; health is topped up so thorns never end the run
+static void benchMovePlayer(BenchContext* context, long iteration) {
+    movePlayer(context->game, (iteration & 1) ? 'q' : 'd');
+    context->game->player.health = 100;
+}
+
+static void benchMoveCrocodiles(BenchContext* context, long iteration) {
+    (void)iteration;
+    moveAllCrocodiles(context->game);
+}
+
+// The pool is emptied every time so snakes never run out of room to shoot
+static void benchSnakesShooting(BenchContext* context, long iteration) {
+    (void)iteration;
+    handleAllSnakesShooting(context->game);
+    clearProjectiles(&context->game->projectiles);
+}
+
+static void benchDangerWarning(BenchContext* context, long iteration) {
+    (void)iteration;
+    dangerWarning(&context->game->player, &context->game->grid);
+}
+
+// The player steps between frames so every frame has something to send
+static void benchDisplayGraph(BenchContext* context, long iteration) {
+    movePlayer(context->game, (iteration & 1) ? 'q' : 'd');
+    context->game->player.health = 100;
+    displayGraph(&context->renderer, context->game);
+}
+
+// Whole ticks with random actions; a finished game is restarted in place
+static void benchGameStep(BenchContext* context, long iteration) {
+    (void)iteration;
+    if (isGameDone(context->game) || gameStatus(context->game) == GAME_AT_PORTAL) {
+        initializeGame(context->game, &context->config);
+    }
+    gameStep(context->game, (Action)(ACTION_MOVE_UP + rngNext(&context->rng) % (ACTION_USE_HEALTH_PACK - ACTION_MOVE_UP + 1)));
+}
+
+static const Benchmark benchmarks[] = {
+    {"initGraphFromMap/smallMap", 20000, setupSmallMap, benchLoadSmallMap},
+    {"initGraphFromMap/bigMap", 20000, setupBigMap, benchLoadBigMap},
+    {"movePlayer", 2000000, setupBigMap, benchMovePlayer},
+    {"moveAllCrocodiles", 500000, setupBigMap, benchMoveCrocodiles},
+    {"handleAllSnakesShooting", 2000000, setupBigMap, benchSnakesShooting},
+    {"dangerWarning", 5000000, setupBigMap, benchDangerWarning},
+    {"displayGraph", 50000, setupBigMap, benchDisplayGraph},
+    {"gameStep", 1000000, setupBigMap, benchGameStep},
+};
+
+#define BENCHMARK_COUNT (int)(sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static int compareLongLong(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char* argv[]) {
+    static GameState game;
+    BenchContext context;
+    long long times[BENCH_MAX_RUNS];
+    int runs = BENCH_DEFAULT_RUNS;
+    double factor = 1.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:f:")) != -1) {
+        switch (opt) {
+            case 'r': runs = atoi(optarg); break;
+            case 'f': factor = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-r runs] [-f iteration factor]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (runs < 1) runs = 1;
+    if (runs > BENCH_MAX_RUNS) runs = BENCH_MAX_RUNS;
+    if (factor <= 0) factor = 1.0;
+
+    // Frames go to /dev/null at the size of a regular terminal
+    memset(&context, 0, sizeof(context));
+    context.game = &game;
+    strcpy(game.player.name, "bench");
+    int sink = open("/dev/null", O_WRONLY);
+    rendererBegin(&context.renderer, sink, SCREEN_WIDTH, 24);
+
+    printf("{\n  \"runs\": %d,\n  \"benchmarks\": [\n", runs);
+    for (int b = 0; b < BENCHMARK_COUNT; b++) {
+        const Benchmark* bench = &benchmarks[b];
+        long iterations = (long)(bench->iterations * factor);
+        unsigned long long allocations = 0, bytes = 0;
+        if (iterations < 1) iterations = 1;
+
+        for (int r = 0; r < runs; r++) {
+            bench->setup(&context);
+            unsigned long long countBefore = allocationCount, bytesBefore = allocatedBytes;
+            long long start = nowNs();
+            for (long i = 0; i < iterations; i++) bench->run(&context, i);
+            times[r] = nowNs() - start;
+            allocations += allocationCount - countBefore;
+            bytes += allocatedBytes - bytesBefore;
+        }
+        qsort(times, runs, sizeof(long long), compareLongLong);
+
+        double perOp = (double)times[runs / 2] / iterations;
+        printf("    {\"name\": \"%s\", \"iterations\": %ld, \"ns_per_op\": %.2f, \"min_ns_per_op\": %.2f, "
+               "\"ops_per_sec\": %.0f, \"allocs_per_op\": %.4f, \"bytes_per_op\": %.2f}%s\n",
+               bench->name, iterations, perOp, (double)times[0] / iterations,
+               perOp > 0 ? 1e9 / perOp : 0.0, (double)allocations / ((double)iterations * runs),
+               (double)bytes / ((double)iterations * runs), b + 1 < BENCHMARK_COUNT ? "," : "");
+        fflush(stdout);
+    }
+    printf("  ]\n}\n");
+
+    rendererEnd(&context.renderer);
+    close(sink);
+    cleanupGame(&game);
+    return 0;
+}
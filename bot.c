@@ -0,0 +1,254 @@
+// Bot front-end: an external agent drives the game through a pair of pipes,
+// one line per tick each way, with no terminal in between.
+//
+//   crocs-bot [-c map/enemies/power] [-s seed] [map]
+//
+// Agent to engine, one line per tick:
+//   z s q d          move          fz fs fq fd   shoot
+//   cz cs cq cd      break thorns  u  r          health pack, checkpoint
+//   1                enter the arena (on the portal)
+//   .  or empty      wait          x             quit
+//   reset [seed]     start a new game
+//   back             undo the last tick, up to BOT_REWIND_TICKS of them
+//   save             keep the whole game as it stands
+//   load             go back to the game kept by the last save
+//
+// Engine to agent, one observation line for the start of every game and
+// for every tick, as space separated key=value fields:
+//   tick= status= hp= score= inv=bullets,axes,food,packs gun= pos=row,col
+//   boss=active,health,phase,row,col enemies=Crow:col,Srow:col,...
+//   shots=row:col:dRow:dCol:owner,... map=ROWSxCOLS:cells
+// The map cells are written row after row with the map file characters,
+// '.' for safe land and 'P' for the player.
+//
+// Lines are handled in the order they arrive and the observations of every
+// line read in one go are written back in one go, so an agent can send
+// several ticks before it reads their observations. Every line is answered:
+// one too long to be an action is played as a wait.
+
+#include "Game.h"
+#include <stdarg.h>
+
+#define BOT_LINE_SIZE 256
+#define BOT_READ_SIZE 65536
+#define BOT_REWIND_TICKS 256
+#define BOT_REWIND_ENTRIES 65536
+
+typedef struct BotOutput {
+    char* data;
+    size_t length;
+    size_t capacity;
+} BotOutput;
+
+// Game kept by the last save line, as a snapshot
+typedef struct BotSave {
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+} BotSave;
+
+// Map file character of every CellType, indexed by CellType
+static const char cellLetters[] = {'.', '#', '+', 'c', 's', 'F', 'G', '*', 'A', 'H', 'O', 'B', 'C'};
+
+static const char* statusNames[] = {"running", "portal", "arena", "dead", "won", "quit"};
+
+static void reserveOutput(BotOutput* output, size_t extra) {
+    if (output->length + extra <= output->capacity) return;
+    size_t capacity = output->capacity > 0 ? output->capacity : 4096;
+    while (capacity < output->length + extra) capacity *= 2;
+    output->data = (char*)realloc(output->data, capacity);
+    output->capacity = capacity;
+}
+
+static void appendf(BotOutput* output, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void appendf(BotOutput* output, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    reserveOutput(output, (size_t)length + 1);
+    va_start(args, format);
+    vsnprintf(output->data + output->length, (size_t)length + 1, format, args);
+    va_end(args);
+    output->length += length;
+}
+
+static void writeObservation(BotOutput* output, GameState* game) {
+    Grid* grid = &game->grid;
+    Player* player = &game->player;
+    int* inventory = player->inventory;
+    const char* separator = "";
+
+    appendf(output, "tick=%lu status=%s hp=%d score=%d inv=%d,%d,%d,%d gun=%d pos=%d,%d",
+            game->tickCount, statusNames[gameStatus(game)], player->health, player->score,
+            inventory[ITEM_BULLETS], inventory[ITEM_AXE], inventory[ITEM_FOOD], inventory[ITEM_HEALTH_PACK],
+            player->hasGun, cellRow(grid, player->position), cellCol(grid, player->position));
+
+    Boss* boss = &game->boss;
+    int bossAlive = boss->isActive && boss->position != NO_CELL;
+    appendf(output, " boss=%d,%d,%d,%d,%d", boss->isActive, boss->health, boss->phaseNumber,
+            bossAlive ? cellRow(grid, boss->position) : -1, bossAlive ? cellCol(grid, boss->position) : -1);
+
+    appendf(output, " enemies=");
+    for (int i = 0; i < game->activeCrocodiles; i++) {
+        int cell = game->crocodiles[i].position;
+        if (cell == NO_CELL || gridType(grid, cell) != CROCODILE) continue;
+        appendf(output, "%sC%d:%d", separator, cellRow(grid, cell), cellCol(grid, cell));
+        separator = ",";
+    }
+    for (int i = 0; i < game->activeSnakes; i++) {
+        int cell = game->snakes[i].position;
+        if (cell == NO_CELL || gridType(grid, cell) != SNAKE) continue;
+        appendf(output, "%sS%d:%d", separator, cellRow(grid, cell), cellCol(grid, cell));
+        separator = ",";
+    }
+
+    appendf(output, " shots=");
+    for (int i = 0; i < game->projectiles.count; i++) {
+        Projectile* shot = &game->projectiles.items[i];
+        appendf(output, "%s%d:%d:%d:%d:%d", i > 0 ? "," : "", cellRow(grid, shot->cell), cellCol(grid, shot->cell),
+                shot->dRow, shot->dCol, (int)shot->owner);
+    }
+
+    appendf(output, " map=%dx%d:", grid->rows, grid->cols);
+    reserveOutput(output, (size_t)grid->cellCount + 2);
+    char* cells = output->data + output->length;
+    for (int row = 0; row < grid->rows; row++) {
+        for (int col = 0; col < grid->cols; col++) *cells++ = cellLetters[gridTypeAt(grid, row, col)];
+    }
+    output->data[output->length + player->position] = 'P';
+    output->length += grid->cellCount;
+    output->data[output->length++] = '\n';
+}
+
+// Action of one input line, in the terminal's keys
+static Action actionFromLine(GameState* game, const char* line) {
+    if (line[0] == 'f' || line[0] == 'c') {
+        return directionalAction(line[0] == 'f' ? ACTION_SHOOT_UP : ACTION_BREAK_UP, line[1]);
+    }
+    if (line[0] == '1') return gameStatus(game) == GAME_AT_PORTAL ? ACTION_ENTER_ARENA : ACTION_NONE;
+    return actionFromKey(line[0]);
+}
+
+static void startGame(GameState* game, const GameConfig* config, unsigned long long seed) {
+    GameConfig start = *config;
+    start.seed = seed;
+    resetGame(game, &start);
+}
+
+static void saveGame(GameState* game, BotSave* save) {
+    size_t length = snapshotSize(game);
+    if (length > save->capacity) {
+        save->data = (unsigned char*)realloc(save->data, length);
+        save->capacity = length;
+    }
+    save->length = saveSnapshot(game, save->data, save->capacity);
+}
+
+// Run one input line; every line gets exactly one observation back
+static void handleLine(GameState* game, const GameConfig* config, unsigned long long* seed,
+                       BotSave* save, char* line, BotOutput* output) {
+    size_t length = strlen(line);
+    while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == ' ')) line[--length] = '\0';
+
+    if (strncmp(line, "reset", 5) == 0) {
+        if (line[5] == ' ') *seed = strtoull(line + 6, NULL, 10);
+        else (*seed)++;
+        startGame(game, config, *seed);
+    } else if (strcmp(line, "back") == 0) {
+        rewindTick(game);   // Nothing left to undo: the observation just repeats
+    } else if (strcmp(line, "save") == 0) {
+        saveGame(game, save);
+    } else if (strcmp(line, "load") == 0) {
+        if (save->length > 0) loadSnapshot(game, save->data, save->length);
+    } else {
+        headlessStep(game, actionFromLine(game, line));
+    }
+    writeObservation(output, game);
+}
+
+int main(int argc, char* argv[]) {
+    static GameState game;
+    static char input[BOT_READ_SIZE];
+    RewindJournal journal;
+    GameConfig config;
+    BotOutput output = {NULL, 0, 0};
+    BotSave save = {NULL, 0, 0};
+    unsigned long long seed = (unsigned long long)time(NULL);
+    char* customMap = NULL;
+    size_t pending = 0;
+    int overlong = 0;           // The line being read already overflowed the buffer
+    int opt;
+
+    configureGame(&config, SMALL_MAP, ENEMY_EASY, POWER_WEAK);
+    while ((opt = getopt(argc, argv, "c:s:")) != -1) {
+        switch (opt) {
+            case 'c':
+                if (configureGameFromLabel(&config, optarg)) break;
+                /* fall through */
+            default:
+                fprintf(stderr, "usage: %s [-c map/enemies/power] [-s seed] [map]\n", argv[0]);
+                return 1;
+            case 's': seed = strtoull(optarg, NULL, 10); break;
+        }
+    }
+    if (optind < argc) {
+        customMap = loadMapFile(argv[optind]);
+        if (customMap == NULL) {
+            fprintf(stderr, "Cannot load map %s (at most %dx%d cells)\n", argv[optind], MAX_MAP_SIZE, MAX_MAP_SIZE);
+            return 1;
+        }
+        config.mapSize = CUSTOM_MAP;
+        config.mapData = customMap;
+    }
+
+    strcpy(game.player.name, "bot");
+    initRewindJournal(&journal, BOT_REWIND_TICKS, BOT_REWIND_ENTRIES);
+    game.grid.journal = &journal;
+    startGame(&game, &config, seed);
+    writeObservation(&output, &game);
+
+    while (1) {
+        // Hand back everything answered so far before waiting for more input
+        size_t sent = 0;
+        while (sent < output.length) {
+            ssize_t written = write(STDOUT_FILENO, output.data + sent, output.length - sent);
+            if (written <= 0) break;
+            sent += written;
+        }
+        if (sent < output.length) break;  // The agent went away
+        output.length = 0;
+
+        ssize_t received = read(STDIN_FILENO, input + pending, sizeof(input) - pending);
+        if (received <= 0) break;
+        pending += received;
+
+        // Answer every complete line; a partial one waits for the rest.
+        // A line too long to be an action still gets its tick, as a wait,
+        // so the agent's count of answers never drifts.
+        char* start = input;
+        char* newline;
+        while ((newline = memchr(start, '\n', pending - (start - input))) != NULL) {
+            *newline = '\0';
+            if (overlong || newline - start >= BOT_LINE_SIZE) start[0] = '\0';
+            handleLine(&game, &config, &seed, &save, start, &output);
+            overlong = 0;
+            start = newline + 1;
+        }
+        pending -= start - input;
+        memmove(input, start, pending);
+        if (pending == sizeof(input)) {
+            pending = 0;    // Drop the start of the line; it is answered when its end arrives
+            overlong = 1;
+        }
+    }
+
+    cleanupGame(&game);
+    cleanupRewindJournal(&journal);
+    free(output.data);
+    free(save.data);
+    free(customMap);
+    return 0;
+}
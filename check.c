@@ -0,0 +1,273 @@
+// Engine self-checks: play seeded games and make sure that two ways of
+// reaching the same game state really reach it. Run by `make check`.
+//
+//   crocs-check [-n games]
+//
+// Game i plays the difficulty i % 8 (map size, enemy count, enemy power)
+// with seed i and random actions drawn from its own generator, so a failure
+// can be replayed from its number.
+// Exits 1 at the first difference, naming the check and the game.
+
+#include "Game.h"
+
+// Built in rather than linked, so the batch check can compare the whole
+// game state of every session and not only what the API hands back
+#include "crocs.c"
+
+#define CHECK_DEFAULT_GAMES 200
+#define CHECK_TICKS 600             // Ticks played per game
+#define CHECK_SNAPSHOT_TICKS 200    // Ticks replayed from a loaded snapshot
+#define CHECK_REWIND_TICKS 64       // Ticks played forward, then rewound
+#define CHECK_REWIND_ENTRIES 65536
+#define CHECK_BATCH_SESSIONS 8
+#define CHECK_OBSERVE_TICKS 10      // Observations and game states are compared once every this many ticks
+
+typedef int (*CheckFunction)(int number);
+
+// A snapshot field set to a value that must get the snapshot refused,
+// together with a second one where it takes two to make it wrong
+typedef struct Corruption {
+    size_t offset;
+    int value;
+    size_t alsoOffset;      // 0 for none
+    int alsoValue;
+} Corruption;
+
+typedef struct Check {
+    const char* name;
+    CheckFunction run;
+} Check;
+
+// Shared by the checks; every check starts both games afresh
+static GameState played, restored;
+
+static unsigned long long mixBytes(unsigned long long hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+// Everything a tick reads or writes, down to the generator and every cell
+static unsigned long long fingerprint(GameState* game) {
+    Grid* grid = &game->grid;
+    unsigned long long hash = hashGameState(game);
+
+    hash = mixBytes(hash, &game->player, sizeof(Player));
+    hash = mixBytes(hash, game->crocodiles, game->activeCrocodiles * sizeof(Crocodile));
+    hash = mixBytes(hash, game->snakes, game->activeSnakes * sizeof(Snake));
+    hash = mixBytes(hash, &game->boss, sizeof(Boss));
+    hash = mixBytes(hash, game->projectiles.items, game->projectiles.count * sizeof(Projectile));
+    hash = mixBytes(hash, &game->rng.state, sizeof(game->rng.state));
+    for (int cell = 0; cell < grid->cellCount; cell++) {
+        int values[] = {gridType(grid, cell), gridHealth(grid, cell), threatCount(grid, cell)};
+        hash = mixBytes(hash, values, sizeof(values));
+    }
+    return hash;
+}
+
+static void startGame(GameState* game, int number) {
+    GameConfig config;
+    configureGame(&config, number % 2, (number / 2) % 2, (number / 4) % 2);
+    config.seed = (unsigned long long)number;
+    strcpy(game->player.name, "check");
+    resetGame(game, &config);
+}
+
+// Any action but quitting
+static void playTick(GameState* game, GameRng* actions) {
+    headlessStep(game, (Action)(rngNext(actions) % ACTION_QUIT));
+}
+
+// Write a value into a copy of a snapshot
+static void patchSnapshot(unsigned char* data, size_t offset, int value) {
+    memcpy(data + offset, &value, sizeof(int));
+}
+
+// A loaded snapshot plays on exactly as the game it was taken from, and one
+// with a cell off the map, a zero divisor or an out-of-range enum is refused
+// without a change
+static int checkSnapshot(int number) {
+    static unsigned long long expected[CHECK_SNAPSHOT_TICKS];
+    GameRng actions = {0x9E3779B97F4A7C15ull ^ (unsigned long long)number};
+    GameRng replay;
+    int ok = 1;
+
+    startGame(&played, number);
+    startGame(&restored, number + 1);
+    int taken = (int)(rngNext(&actions) % (CHECK_TICKS - CHECK_SNAPSHOT_TICKS));
+    for (int tick = 0; tick < taken; tick++) playTick(&played, &actions);
+
+    size_t length = snapshotSize(&played);
+    unsigned char* data = (unsigned char*)malloc(length);
+    unsigned char* bad = (unsigned char*)malloc(length);
+    if (saveSnapshot(&played, data, length) != length) ok = 0;
+
+    size_t player = sizeof(SnapshotHeader);
+    size_t config = player + sizeof(Player);
+    size_t boss = config + sizeof(GameConfig) + sizeof(played.crocodiles) + sizeof(int) + sizeof(played.snakes) +
+                  sizeof(int);
+    size_t projectiles = boss + sizeof(Boss);
+    Corruption corruptions[] = {
+        {player + offsetof(Player, position), played.grid.cellCount, 0, 0},
+        {player + offsetof(Player, position), NO_CELL, 0, 0},
+        {player + offsetof(Player, checkpoints.depth), 0, 0, 0},
+        {player + offsetof(Player, lastDamage), DAMAGE_CAUSE_COUNT, 0, 0},
+        {player + offsetof(Player, lastDamage), -1, 0, 0},
+        {config + offsetof(GameConfig, enemyTurnTicks), 0, 0, 0},
+        {config + offsetof(GameConfig, projectileSpeed), 0, 0, 0},
+        {boss + offsetof(Boss, isActive), 1, boss + offsetof(Boss, position), NO_CELL},
+        {projectiles, MAX_PROJECTILES + 1, 0, 0}
+    };
+    unsigned long long before = fingerprint(&restored);
+    for (size_t i = 0; ok && i < sizeof(corruptions) / sizeof(corruptions[0]); i++) {
+        memcpy(bad, data, length);
+        patchSnapshot(bad, corruptions[i].offset, corruptions[i].value);
+        if (corruptions[i].alsoOffset != 0) patchSnapshot(bad, corruptions[i].alsoOffset, corruptions[i].alsoValue);
+        if (loadSnapshot(&restored, bad, length) || fingerprint(&restored) != before) ok = 0;
+    }
+    if (ok && (loadSnapshot(&restored, data, length - 1) || fingerprint(&restored) != before)) ok = 0;
+
+    replay = actions;
+    for (int tick = 0; tick < CHECK_SNAPSHOT_TICKS; tick++) {
+        playTick(&played, &actions);
+        expected[tick] = fingerprint(&played);
+    }
+    if (ok && !loadSnapshot(&restored, data, length)) ok = 0;
+    for (int tick = 0; ok && tick < CHECK_SNAPSHOT_TICKS; tick++) {
+        playTick(&restored, &replay);
+        if (fingerprint(&restored) != expected[tick]) ok = 0;
+    }
+
+    free(data);
+    free(bad);
+    return ok;
+}
+
+// Stepping some ticks and rewinding as many goes back through exactly the
+// states the game passed on the way, and stops once the journal is empty.
+// Ticks of a finished game are not recorded and entering the arena clears
+// the journal, so states are kept by the journal's own tick count.
+static int checkRewind(int number) {
+    static unsigned long long expected[CHECK_REWIND_TICKS];
+    GameRng actions = {0x9E3779B97F4A7C15ull ^ (unsigned long long)number};
+    RewindJournal journal;
+    int ok = 1;
+
+    initRewindJournal(&journal, CHECK_REWIND_TICKS, CHECK_REWIND_ENTRIES);
+    startGame(&played, number);
+    played.grid.journal = &journal;
+
+    for (int round = 0; ok && round * CHECK_REWIND_TICKS < CHECK_TICKS; round++) {
+        int ticks = 1 + (int)(rngNext(&actions) % CHECK_REWIND_TICKS);
+        clearRewindJournal(&journal);
+        for (int tick = 0; tick < ticks; tick++) {
+            expected[journal.tickCount] = fingerprint(&played);
+            playTick(&played, &actions);
+        }
+        for (int tick = journal.tickCount - 1; ok && tick >= 0; tick--) {
+            if (!rewindTick(&played) || fingerprint(&played) != expected[tick]) ok = 0;
+        }
+        if (rewindTick(&played)) ok = 0;
+
+        // Then play on, so the next round starts further into the game
+        for (int tick = 0; tick < ticks; tick++) playTick(&played, &actions);
+    }
+
+    played.grid.journal = NULL;
+    cleanupRewindJournal(&journal);
+    return ok;
+}
+
+// Mostly plain actions; now and then a quit, or one out of range that plays as a wait
+static int batchAction(GameRng* actions) {
+    unsigned int roll = rngNext(actions) % 256;
+    if (roll == 0) return CROCS_ACTION_QUIT;
+    if (roll == 1) return CROCS_ACTION_COUNT;
+    return (int)(roll % CROCS_ACTION_QUIT);
+}
+
+// A batch plays every session exactly as crocsStep plays it alone: same
+// statuses, rewards, game states and observations, including sessions
+// reset on the way
+static int checkBatch(int number) {
+    static const char* labels[] = {"small/few/weak", "big/few/weak", "small/many/weak", "big/many/weak",
+                                   "small/few/strong", "big/few/strong", "small/many/strong", "big/many/strong"};
+    const char* label = labels[number % 8];
+    unsigned long long seed = (unsigned long long)number * CHECK_BATCH_SESSIONS;
+    GameRng actions = {0x9E3779B97F4A7C15ull ^ (unsigned long long)number};
+    CrocsBatch* batch = crocsBatchCreate(CHECK_BATCH_SESSIONS, label);
+    CrocsEnv* envs[CHECK_BATCH_SESSIONS];
+    int moves[CHECK_BATCH_SESSIONS], statuses[CHECK_BATCH_SESSIONS];
+    float rewards[CHECK_BATCH_SESSIONS];
+    int ok = 1;
+
+    if (batch == NULL) return 0;
+    crocsBatchReset(batch, -1, seed);
+    for (int i = 0; i < CHECK_BATCH_SESSIONS; i++) {
+        envs[i] = crocsCreate();
+        crocsReset(envs[i], seed + i, label);
+    }
+    size_t size = crocsBatchObservationSize(batch);
+    float* observed = (float*)malloc(size * CHECK_BATCH_SESSIONS * sizeof(float));
+    float* alone = (float*)malloc(size * sizeof(float));
+
+    for (int tick = 0; ok && tick < CHECK_TICKS; tick++) {
+        for (int i = 0; i < CHECK_BATCH_SESSIONS; i++) moves[i] = batchAction(&actions);
+        crocsBatchStep(batch, moves, rewards, statuses);
+        for (int i = 0; i < CHECK_BATCH_SESSIONS; i++) {
+            float reward;
+            if (crocsStep(envs[i], moves[i], &reward) != statuses[i] || reward != rewards[i]) ok = 0;
+            if (statuses[i] >= CROCS_STATUS_DEAD && rngNext(&actions) % 4 == 0) {
+                crocsReset(envs[i], seed + tick, label);
+                crocsBatchReset(batch, i, seed + tick);
+            }
+        }
+        if (tick % CHECK_OBSERVE_TICKS != 0) continue;
+        crocsBatchObserve(batch, observed);
+        for (int i = 0; i < CHECK_BATCH_SESSIONS; i++) {
+            crocsObserve(envs[i], alone);
+            if (memcmp(alone, observed + i * size, size * sizeof(float)) != 0 ||
+                fingerprint(&envs[i]->game) != fingerprint(&batch->envs[i].game)) ok = 0;
+        }
+    }
+
+    for (int i = 0; i < CHECK_BATCH_SESSIONS; i++) crocsDestroy(envs[i]);
+    crocsBatchDestroy(batch);
+    free(observed);
+    free(alone);
+    return ok;
+}
+
+static const Check checks[] = {
+    {"snapshot", checkSnapshot},
+    {"rewind", checkRewind},
+    {"batch", checkBatch}
+};
+#define CHECK_COUNT (int)(sizeof(checks) / sizeof(checks[0]))
+
+int main(int argc, char* argv[]) {
+    int count = CHECK_DEFAULT_GAMES;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+            case 'n': count = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-n games]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    for (int i = 0; i < CHECK_COUNT; i++) {
+        for (int number = 0; number < count; number++) {
+            if (!checks[i].run(number)) {
+                printf("%s: game %d differs\n", checks[i].name, number);
+                return 1;
+            }
+        }
+        printf("%s: %d games ok\n", checks[i].name, count);
+    }
+    cleanupGame(&played);
+    cleanupGame(&restored);
+    return 0;
+}
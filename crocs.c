@@ -0,0 +1,214 @@
+// Embedding API (crocs.h) over the engine in Game.c, built as libcrocs.so.
+// An environment is one GameState plus the observation shape, which is
+// picked at reset so it also fits the boss arena.
+
+#include "Game.h"
+#include "crocs.h"
+
+_Static_assert(CROCS_ACTION_ENTER_ARENA == ACTION_ENTER_ARENA && CROCS_ACTION_COUNT == ACTION_QUIT + 1,
+               "crocs.h actions out of step with Action");
+_Static_assert(CROCS_STATUS_DEAD == GAME_PLAYER_DEAD && CROCS_STATUS_QUIT == GAME_QUIT,
+               "crocs.h statuses out of step with GameStatus");
+_Static_assert(CROCS_CELL_TYPES == CHECKPOINT + 1, "crocs.h cell types out of step with CellType");
+_Static_assert(CROCS_PLAYER_SCALARS == ITEM_KIND_COUNT + 5, "crocs.h player scalars out of step with ItemKind");
+
+struct CrocsEnv {
+    GameState game;
+    int rows;       // Observation planes, big enough for the map and the arena
+    int cols;
+};
+
+struct CrocsBatch {
+    int count;
+    GameConfig config;      // Shared by every session, so they all have one observation shape
+    CrocsEnv* envs;         // The sessions, back to back in one block
+    unsigned char* turns;   // Whether the enemies act in the tick being played
+    int* statuses;          // Status of every session after the last step
+    int* scores;            // Score of every session after the last step
+};
+
+// Parse a label, NULL meaning the default small/few/weak game
+static int configFromLabel(GameConfig* config, const char* label) {
+    if (label != NULL) return configureGameFromLabel(config, label);
+    configureGame(config, SMALL_MAP, ENEMY_EASY, POWER_WEAK);
+    return 1;
+}
+
+static void resetEnv(CrocsEnv* env, const GameConfig* config, unsigned long long seed) {
+    GameConfig start = *config;
+    int mapRows, mapCols, arenaRows, arenaCols;
+    start.seed = seed;
+    resetGame(&env->game, &start);
+
+    measureMap(start.mapData, &mapRows, &mapCols);
+    measureMap(bossMap, &arenaRows, &arenaCols);
+    env->rows = mapRows > arenaRows ? mapRows : arenaRows;
+    env->cols = mapCols > arenaCols ? mapCols : arenaCols;
+}
+
+CrocsEnv* crocsCreate(void) {
+    CrocsEnv* env = (CrocsEnv*)calloc(1, sizeof(CrocsEnv));
+    if (env == NULL) return NULL;
+    strcpy(env->game.player.name, "agent");
+    return env;
+}
+
+void crocsDestroy(CrocsEnv* env) {
+    if (env == NULL) return;
+    cleanupGame(&env->game);
+    free(env);
+}
+
+int crocsReset(CrocsEnv* env, unsigned long long seed, const char* config) {
+    GameConfig start;
+    if (!configFromLabel(&start, config)) return 0;
+    resetEnv(env, &start, seed);
+    return 1;
+}
+
+// One tick of one session; the batch calls it too, so both give the same games
+static int stepEnv(CrocsEnv* env, int action) {
+    GameState* game = &env->game;
+
+    if (action < 0 || action >= CROCS_ACTION_COUNT) action = ACTION_NONE;
+    headlessStep(game, (Action)action);
+    return gameStatus(game);
+}
+
+int crocsStep(CrocsEnv* env, int action, float* reward) {
+    int score = env->game.player.score;
+    int status = stepEnv(env, action);
+    if (reward != NULL) *reward = (float)(env->game.player.score - score);
+    return status;
+}
+
+size_t crocsObservationSize(const CrocsEnv* env) {
+    return (size_t)CROCS_CELL_TYPES * env->rows * env->cols + CROCS_PLAYER_SCALARS + CROCS_BOSS_SCALARS;
+}
+
+void crocsObservationShape(const CrocsEnv* env, int* planes, int* rows, int* cols) {
+    *planes = CROCS_CELL_TYPES;
+    *rows = env->rows;
+    *cols = env->cols;
+}
+
+void crocsObserve(const CrocsEnv* env, float* buffer) {
+    const GameState* game = &env->game;
+    const Grid* grid = &game->grid;
+    const Player* player = &game->player;
+    const Boss* boss = &game->boss;
+    size_t planeCells = (size_t)env->rows * env->cols;
+
+    memset(buffer, 0, CROCS_CELL_TYPES * planeCells * sizeof(float));
+    for (int row = 0; row < grid->rows; row++) {
+        float* line = buffer + (size_t)row * env->cols;
+        for (int col = 0; col < grid->cols; col++) line[gridTypeAt(grid, row, col) * planeCells + col] = 1.0f;
+    }
+
+    float* scalars = buffer + CROCS_CELL_TYPES * planeCells;
+    *scalars++ = (float)cellRow(grid, player->position);
+    *scalars++ = (float)cellCol(grid, player->position);
+    *scalars++ = (float)player->health;
+    *scalars++ = (float)player->score;
+    for (int item = 0; item < ITEM_KIND_COUNT; item++) *scalars++ = (float)player->inventory[item];
+    *scalars++ = (float)player->hasGun;
+
+    int bossPlaced = boss->isActive && boss->position != NO_CELL;
+    *scalars++ = (float)boss->isActive;
+    *scalars++ = (float)boss->health;
+    *scalars++ = (float)boss->phaseNumber;
+    *scalars++ = bossPlaced ? (float)cellRow(grid, boss->position) : -1.0f;
+    *scalars = bossPlaced ? (float)cellCol(grid, boss->position) : -1.0f;
+}
+
+static void freeBatchArrays(CrocsBatch* batch) {
+    free(batch->envs);
+    free(batch->turns);
+    free(batch->statuses);
+    free(batch->scores);
+}
+
+CrocsBatch* crocsBatchCreate(int count, const char* config) {
+    if (count < 1) return NULL;
+    CrocsBatch* batch = (CrocsBatch*)calloc(1, sizeof(CrocsBatch));
+    if (batch == NULL) return NULL;
+    if (!configFromLabel(&batch->config, config)) {
+        free(batch);
+        return NULL;
+    }
+
+    batch->count = count;
+    batch->envs = (CrocsEnv*)calloc(count, sizeof(CrocsEnv));
+    batch->turns = (unsigned char*)calloc(count, 1);
+    batch->statuses = (int*)calloc(count, sizeof(int));
+    batch->scores = (int*)calloc(count, sizeof(int));
+    if (batch->envs == NULL || batch->turns == NULL || batch->statuses == NULL || batch->scores == NULL) {
+        freeBatchArrays(batch);
+        free(batch);
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) strcpy(batch->envs[i].game.player.name, "agent");
+    crocsBatchReset(batch, -1, 1);
+    return batch;
+}
+
+void crocsBatchDestroy(CrocsBatch* batch) {
+    if (batch == NULL) return;
+    for (int i = 0; i < batch->count; i++) cleanupGame(&batch->envs[i].game);
+    freeBatchArrays(batch);
+    free(batch);
+}
+
+int crocsBatchSize(const CrocsBatch* batch) {
+    return batch->count;
+}
+
+void crocsBatchReset(CrocsBatch* batch, int index, unsigned long long seed) {
+    int first = index < 0 ? 0 : index;
+    int last = index < 0 ? batch->count - 1 : index;
+    for (int i = first; i <= last && i < batch->count; i++) {
+        resetEnv(&batch->envs[i], &batch->config, index < 0 ? seed + i : seed);
+        batch->statuses[i] = gameStatus(&batch->envs[i].game);
+        batch->scores[i] = batch->envs[i].game.player.score;
+    }
+}
+
+// Same tick as stepEnv for every session, in two passes: every player's
+// half of the tick, then the enemies of the sessions whose turn it is
+void crocsBatchStep(CrocsBatch* batch, const int* actions, float* rewards, int* statuses) {
+    // Finished sessions are skipped from the status array alone, without
+    // pulling their game state into the cache
+    for (int i = 0; i < batch->count; i++) {
+        int action = actions[i];
+        batch->turns[i] = 0;
+        if (batch->statuses[i] >= CROCS_STATUS_DEAD) continue;
+
+        if (action < 0 || action >= CROCS_ACTION_COUNT) action = ACTION_NONE;
+        batch->turns[i] = (unsigned char)playerTick(&batch->envs[i].game, (Action)action);
+    }
+
+    for (int i = 0; i < batch->count; i++) {
+        GameState* game = &batch->envs[i].game;
+        if (batch->statuses[i] >= CROCS_STATUS_DEAD) continue;
+
+        if (batch->turns[i]) enemyTurn(game);
+        enterArenaIfReady(game);
+        batch->statuses[i] = gameStatus(game);
+    }
+
+    for (int i = 0; i < batch->count; i++) {
+        int gained = batch->envs[i].game.player.score - batch->scores[i];
+        batch->scores[i] += gained;
+        if (rewards != NULL) rewards[i] = (float)gained;
+    }
+    if (statuses != NULL) memcpy(statuses, batch->statuses, batch->count * sizeof(int));
+}
+
+size_t crocsBatchObservationSize(const CrocsBatch* batch) {
+    return crocsObservationSize(&batch->envs[0]);
+}
+
+void crocsBatchObserve(const CrocsBatch* batch, float* buffer) {
+    size_t size = crocsBatchObservationSize(batch);
+    for (int i = 0; i < batch->count; i++) crocsObserve(&batch->envs[i], buffer + i * size);
+}
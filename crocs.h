@@ -0,0 +1,93 @@
+#ifndef CROCS_H
+#define CROCS_H
+
+// Embedding API of libcrocs.so, for trainers that drive the game through
+// FFI. It only uses plain C types so it can be declared from any language
+// without Game.h:
+//
+//   CrocsEnv* env = crocsCreate();
+//   crocsReset(env, seed, "small/few/weak");
+//   float* observation = malloc(crocsObservationSize(env) * sizeof(float));
+//   while (crocsStep(env, action, &reward) < CROCS_STATUS_DEAD) crocsObserve(env, observation);
+//
+// Every environment is independent, so several can run on different threads.
+// Once reset, neither crocsStep nor crocsObserve allocates memory.
+
+#include <stddef.h>
+
+// Actions, numbered as Action in Game.h
+#define CROCS_ACTION_NONE 0
+#define CROCS_ACTION_MOVE_UP 1          // Then down, left, right
+#define CROCS_ACTION_SHOOT_UP 5         // Then down, left, right
+#define CROCS_ACTION_BREAK_UP 9         // Then down, left, right
+#define CROCS_ACTION_USE_HEALTH_PACK 13
+#define CROCS_ACTION_RETURN_CHECKPOINT 14
+#define CROCS_ACTION_ENTER_ARENA 15     // Only does something on the portal
+#define CROCS_ACTION_QUIT 16
+#define CROCS_ACTION_COUNT 17
+
+// Statuses returned by crocsStep, numbered as GameStatus in Game.h. The
+// arena is entered as soon as the game asks for it, so its "ready" status
+// never comes out of crocsStep.
+#define CROCS_STATUS_RUNNING 0
+#define CROCS_STATUS_AT_PORTAL 1
+#define CROCS_STATUS_DEAD 3
+#define CROCS_STATUS_WON 4
+#define CROCS_STATUS_QUIT 5
+
+// Observation layout, in floats:
+//   CROCS_CELL_TYPES planes of rows * cols, one per CellType of Game.h, with
+//   1 where the cell holds that type and 0 elsewhere. rows and cols fit both
+//   the game map and the boss arena, and cells past the current map are 0.
+//   Then the player: row, col, health, score, bullets, axes, food,
+//   health packs, has gun.
+//   Then the boss: active, health, phase, row, col (row and col -1 while
+//   there is no boss).
+#define CROCS_CELL_TYPES 13
+#define CROCS_PLAYER_SCALARS 9
+#define CROCS_BOSS_SCALARS 5
+
+typedef struct CrocsEnv CrocsEnv;
+
+CrocsEnv* crocsCreate(void);
+void crocsDestroy(CrocsEnv* env);
+
+// Start a new game. config is a "small/few/weak" style label, as printed by
+// crocs-sim, or NULL for small/few/weak. Returns 0 if the label is not valid.
+int crocsReset(CrocsEnv* env, unsigned long long seed, const char* config);
+
+// Play one tick and return the status after it. reward, if not NULL, gets
+// the score gained during the tick.
+int crocsStep(CrocsEnv* env, int action, float* reward);
+
+// Floats crocsObserve writes; the shape only changes on a reset with another map size
+size_t crocsObservationSize(const CrocsEnv* env);
+void crocsObservationShape(const CrocsEnv* env, int* planes, int* rows, int* cols);
+void crocsObserve(const CrocsEnv* env, float* buffer);
+
+// Lockstep batch: count sessions of one config, moved forward together by
+// one crocsBatchStep call. Per-session results live in arrays indexed by
+// session, and every session plays exactly as it would through crocsStep
+// with the same seed and actions.
+typedef struct CrocsBatch CrocsBatch;
+
+// NULL if count is below 1 or the label is not valid. Sessions start reset
+// with seeds 1, 2, 3...
+CrocsBatch* crocsBatchCreate(int count, const char* config);
+void crocsBatchDestroy(CrocsBatch* batch);
+int crocsBatchSize(const CrocsBatch* batch);
+
+// Restart one session with the seed, or every session (index -1) with
+// seeds seed, seed + 1, seed + 2...
+void crocsBatchReset(CrocsBatch* batch, int index, unsigned long long seed);
+
+// One tick for every session. actions has one entry per session; rewards
+// and statuses, if not NULL, get one each. Finished sessions stay as they
+// are until they are reset.
+void crocsBatchStep(CrocsBatch* batch, const int* actions, float* rewards, int* statuses);
+
+// Observations of every session, back to back, each laid out as crocsObserve's
+size_t crocsBatchObservationSize(const CrocsBatch* batch);
+void crocsBatchObserve(const CrocsBatch* batch, float* buffer);
+
+#endif
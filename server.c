@@ -0,0 +1,432 @@
+// Multi-session game server. Every connection plays its own game on the same
+// engine as the terminal front-end and gets the ANSI frames back, so any
+// raw-mode client (nc, socat, telnet) can play:
+//
+//   crocs-server [-u path | -p port] [-t reactors] [-c map/enemies/power] [-n max sessions]
+//
+// Each reactor thread runs one epoll loop over its connections plus a single
+// timerfd that ticks all of its sessions together; no thread per player.
+
+#define _GNU_SOURCE     // accept4
+#include "Game.h"
+#include <errno.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define SERVER_DEFAULT_PORT 4242
+#define SERVER_MAX_EVENTS 256
+#define SERVER_MAX_REACTORS 64
+#define SERVER_READ_SIZE 256
+#define SERVER_MAX_OUTPUT (1 << 20)     // A client this far behind is dropped
+#define SERVER_SCREEN_ROWS 24           // Clients can't report their size; assume a plain terminal
+
+typedef struct Reactor Reactor;
+
+// One connected player
+typedef struct Session {
+    int fd;
+    Reactor* reactor;
+    GameState game;
+    Renderer renderer;
+    KeyInput input;             // Keys received since the last tick
+    int closing;                // Game over: close once the last bytes are out
+    int inputClosed;            // The client stopped sending; the game ends on the next tick
+    int watched;                // The socket is registered with epoll
+    int dead;                   // Closed; freed once the current batch of events is handled
+    char* output;               // Frame bytes not yet accepted by the socket
+    size_t outputLength;
+    size_t outputSent;
+    size_t outputCapacity;
+    struct Session* prev;
+    struct Session* next;
+} Session;
+
+struct Reactor {
+    int epoll;
+    int timer;
+    int listener;
+    int spare;                  // Kept open so a client can still be accepted and turned away when out of descriptors
+    Session* sessions;
+    Session* closed;            // Closed sessions that events of the current batch may still name
+    int sessionCount;
+    pthread_t thread;
+};
+
+typedef struct ServerConfig {
+    GameConfig game;
+    const char* socketPath;
+    int port;
+    int reactorCount;
+    int maxSessions;
+} ServerConfig;
+
+static ServerConfig server;
+static int sessionTotal;    // Sessions open over all reactors
+static pthread_mutex_t sessionTotalLock = PTHREAD_MUTEX_INITIALIZER;
+
+// epoll tags for the two descriptors that are not sessions
+static char listenerTag, timerTag;
+
+static void sessionClose(Session* session);
+
+// Ask epoll for input while the client may still send, and for room to
+// write while frame bytes are waiting. With neither, the socket leaves epoll
+// altogether, or a hung-up peer would keep waking the loop.
+static void sessionWatch(Session* session) {
+    struct epoll_event event;
+    event.events = (session->inputClosed ? 0 : EPOLLIN) | (session->outputSent < session->outputLength ? EPOLLOUT : 0);
+    event.data.ptr = session;
+    if (event.events == 0) {
+        if (session->watched) epoll_ctl(session->reactor->epoll, EPOLL_CTL_DEL, session->fd, NULL);
+        session->watched = 0;
+        return;
+    }
+    epoll_ctl(session->reactor->epoll, session->watched ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, session->fd, &event);
+    session->watched = 1;
+}
+
+// Renderer sink: frames are queued and sent as the socket accepts them
+static void sessionQueue(void* context, const char* data, size_t length) {
+    Session* session = (Session*)context;
+    if (session->outputLength + length > session->outputCapacity) {
+        size_t capacity = session->outputCapacity > 0 ? session->outputCapacity : 4096;
+        while (capacity < session->outputLength + length) capacity *= 2;
+        session->output = (char*)realloc(session->output, capacity);
+        session->outputCapacity = capacity;
+    }
+    memcpy(session->output + session->outputLength, data, length);
+    session->outputLength += length;
+}
+
+// Send what the socket takes now; wait for EPOLLOUT for the rest.
+// Returns 0 once the session has been closed.
+static int sessionFlush(Session* session) {
+    while (session->outputSent < session->outputLength) {
+        ssize_t written = send(session->fd, session->output + session->outputSent,
+                               session->outputLength - session->outputSent, MSG_NOSIGNAL);
+        if (written > 0) {
+            session->outputSent += written;
+            continue;
+        }
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (session->outputLength - session->outputSent > SERVER_MAX_OUTPUT) break;
+            sessionWatch(session);
+            return 1;
+        }
+        sessionClose(session);
+        return 0;
+    }
+    if (session->outputSent < session->outputLength) {
+        sessionClose(session);  // Too slow to keep up
+        return 0;
+    }
+
+    session->outputLength = session->outputSent = 0;
+    if (session->closing) {
+        sessionClose(session);
+        return 0;
+    }
+    sessionWatch(session);
+    return 1;
+}
+
+static void sessionOpen(Reactor* reactor, int fd) {
+    Session* session = (Session*)calloc(1, sizeof(Session));
+    session->fd = fd;
+    session->reactor = reactor;
+
+    GameConfig config = server.game;
+    config.seed = ((unsigned long long)time(NULL) << 20) ^ (unsigned long long)monotonicMs() ^ (unsigned long long)fd;
+    snprintf(session->game.player.name, MAX_NAME_LENGTH, "player%d", fd);
+    initializeGame(&session->game, &config);
+
+    // Size the frame like the terminal loop does, for a 24x80 terminal
+    int height = session->game.grid.rows + HUD_LINES;
+    if (height > SERVER_SCREEN_ROWS) height = SERVER_SCREEN_ROWS;
+    session->renderer.sink = sessionQueue;
+    session->renderer.sinkContext = session;
+    rendererBegin(&session->renderer, fd, SCREEN_WIDTH, height);
+
+    session->next = reactor->sessions;
+    if (reactor->sessions != NULL) reactor->sessions->prev = session;
+    reactor->sessions = session;
+    reactor->sessionCount++;
+
+    sessionWatch(session);
+    displayGraph(&session->renderer, &session->game);
+    sessionFlush(session);
+}
+
+// The session stops here, but its memory is only released by reactorReap:
+// events already returned by epoll_wait may still point to it
+static void sessionClose(Session* session) {
+    Reactor* reactor = session->reactor;
+
+    if (session->dead) return;
+    session->dead = 1;
+    if (session->watched) epoll_ctl(reactor->epoll, EPOLL_CTL_DEL, session->fd, NULL);
+    close(session->fd);
+    if (session->prev != NULL) session->prev->next = session->next;
+    else reactor->sessions = session->next;
+    if (session->next != NULL) session->next->prev = session->prev;
+    reactor->sessionCount--;
+
+    session->renderer.sink = NULL;  // Nobody is left to send the exit sequence to
+    session->renderer.fd = -1;
+    rendererEnd(&session->renderer);
+    cleanupGame(&session->game);
+    session->next = reactor->closed;
+    reactor->closed = session;
+
+    pthread_mutex_lock(&sessionTotalLock);
+    sessionTotal--;
+    pthread_mutex_unlock(&sessionTotalLock);
+}
+
+// Keys arrive as the bytes a terminal in raw mode sends
+static void sessionRead(Session* session) {
+    char buffer[SERVER_READ_SIZE];
+    while (1) {
+        ssize_t length = recv(session->fd, buffer, sizeof(buffer), 0);
+        if (length < 0 && errno == EINTR) continue;
+        if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (length <= 0) {
+            // Gone: the game is quit on the next tick, like a closed terminal
+            session->inputClosed = 1;
+            sessionWatch(session);
+            return;
+        }
+        for (ssize_t i = 0; i < length; i++) {
+            if (buffer[i] == '\r' || buffer[i] == '\n') continue;
+            queueKey(&session->input, (unsigned char)buffer[i]);
+        }
+    }
+}
+
+// Last frame of a finished game; the connection closes once it is sent
+static void sessionFinish(Session* session, const char* message) {
+    if (message != NULL) strcpy(session->game.player.message, message);
+    setPrompt(&session->renderer, "", "Fin de la partie.");
+    displayGraph(&session->renderer, &session->game);
+    rendererEnd(&session->renderer);
+    session->closing = 1;
+}
+
+// One tick of one session, the same steps as the terminal loop. Returns 0
+// once the session has been closed.
+static int sessionTick(Session* session) {
+    GameState* game = &session->game;
+    Renderer* renderer = &session->renderer;
+    GameStatus status = gameStatus(game);
+
+    if (session->closing) return 1;  // Waiting for the last frame to go out
+    if (session->inputClosed) {
+        sessionFinish(session, NULL);
+        return sessionFlush(session);
+    }
+    if (enterArenaIfReady(game)) status = gameStatus(game);
+    if (status == GAME_PLAYER_DEAD) {
+        sessionFinish(session, "Game Over - Vous avez ete vaincu !");
+        return sessionFlush(session);
+    }
+    if (status == GAME_BOSS_DEFEATED || status == GAME_QUIT) {
+        sessionFinish(session, NULL);
+        return sessionFlush(session);
+    }
+
+    int promptChanged = showPortalPrompt(renderer, status, &session->input);
+    int hadKeys = session->input.count > 0;
+    gameStep(game, takeKeyAction(renderer, game, &session->input));
+
+    // Only compose a frame when something may have changed on it, and not
+    // while the previous one is still on its way
+    int changed = hadKeys || promptChanged || game->projectiles.count > 0 ||
+                  game->tickCount % game->config.enemyTurnTicks == 0;
+    if (changed && session->outputLength == 0) {
+        displayGraph(renderer, game);
+        return sessionFlush(session);
+    }
+    return 1;
+}
+
+// Free the sessions closed while the last batch of events was handled
+static void reactorReap(Reactor* reactor) {
+    while (reactor->closed != NULL) {
+        Session* session = reactor->closed;
+        reactor->closed = session->next;
+        free(session->output);
+        free(session);
+    }
+}
+
+static void reactorAccept(Reactor* reactor) {
+    while (1) {
+        int fd = accept4(reactor->listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if ((errno != EMFILE && errno != ENFILE) || reactor->spare < 0) return;
+
+            // The listener stays readable while the client waits, so drop it
+            // rather than wake up for it again on every event
+            close(reactor->spare);
+            fd = accept4(reactor->listener, NULL, NULL, SOCK_CLOEXEC);
+            if (fd >= 0) close(fd);
+            reactor->spare = open("/dev/null", O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return;
+            continue;
+        }
+
+        pthread_mutex_lock(&sessionTotalLock);
+        int full = sessionTotal >= server.maxSessions;
+        if (!full) sessionTotal++;
+        pthread_mutex_unlock(&sessionTotalLock);
+        if (full) {
+            const char busy[] = "Server full, try again later.\r\n";
+            send(fd, busy, sizeof(busy) - 1, MSG_NOSIGNAL);
+            close(fd);
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));  // Fails harmlessly on Unix sockets
+        sessionOpen(reactor, fd);
+    }
+}
+
+static void reactorTick(Reactor* reactor) {
+    unsigned long long expirations;
+    if (read(reactor->timer, &expirations, sizeof(expirations)) != sizeof(expirations)) return;
+
+    // Like the terminal loop, don't try to catch up after a stall
+    Session* session = reactor->sessions;
+    while (session != NULL) {
+        Session* next = session->next;
+        sessionTick(session);
+        session = next;
+    }
+}
+
+static void* reactorMain(void* argument) {
+    Reactor* reactor = (Reactor*)argument;
+    struct epoll_event events[SERVER_MAX_EVENTS];
+
+    while (1) {
+        int count = epoll_wait(reactor->epoll, events, SERVER_MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            void* tag = events[i].data.ptr;
+            if (tag == &listenerTag) {
+                reactorAccept(reactor);
+            } else if (tag == &timerTag) {
+                reactorTick(reactor);
+            } else {
+                Session* session = (Session*)tag;
+                if (session->dead) continue;  // Closed earlier in this batch
+                // A hang-up with frames still queued ends in a failed send, which closes the session
+                if ((events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) && session->outputSent < session->outputLength) {
+                    if (!sessionFlush(session)) continue;
+                }
+                if (!session->inputClosed && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) sessionRead(session);
+            }
+        }
+        reactorReap(reactor);
+    }
+    return NULL;
+}
+
+static int openListener(void) {
+    int fd;
+    if (server.socketPath != NULL) {
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, server.socketPath, sizeof(address.sun_path) - 1);
+        unlink(server.socketPath);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0 || bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0) return -1;
+    } else {
+        // Loopback only: the server is meant for one box
+        struct sockaddr_in address;
+        int one = 1;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons((unsigned short)server.port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0) return -1;
+    }
+    if (listen(fd, SOMAXCONN) < 0) return -1;
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    Reactor reactors[SERVER_MAX_REACTORS];
+    int opt;
+
+    configureGame(&server.game, SMALL_MAP, ENEMY_EASY, POWER_WEAK);
+    server.port = SERVER_DEFAULT_PORT;
+    server.reactorCount = 1;
+    server.maxSessions = 10000;
+    while ((opt = getopt(argc, argv, "u:p:t:c:n:")) != -1) {
+        switch (opt) {
+            case 'u': server.socketPath = optarg; break;
+            case 'p': server.port = atoi(optarg); break;
+            case 't': server.reactorCount = atoi(optarg); break;
+            case 'n': server.maxSessions = atoi(optarg); break;
+            case 'c':
+                if (configureGameFromLabel(&server.game, optarg)) break;
+                /* fall through */
+            default:
+                fprintf(stderr, "usage: %s [-u path | -p port] [-t reactors] [-c map/enemies/power] [-n max sessions]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (server.reactorCount < 1) server.reactorCount = 1;
+    if (server.reactorCount > SERVER_MAX_REACTORS) server.reactorCount = SERVER_MAX_REACTORS;
+
+    signal(SIGPIPE, SIG_IGN);
+    int listener = openListener();
+    if (listener < 0) {
+        perror("listen");
+        return 1;
+    }
+
+    // Every reactor watches the listener; EPOLLEXCLUSIVE wakes only one per connection
+    long tickNs = 1000000000L / server.game.tickRateHz;
+    struct itimerspec period = {{tickNs / 1000000000L, tickNs % 1000000000L}, {tickNs / 1000000000L, tickNs % 1000000000L}};
+    for (int r = 0; r < server.reactorCount; r++) {
+        Reactor* reactor = &reactors[r];
+        memset(reactor, 0, sizeof(*reactor));
+        reactor->listener = listener;
+        reactor->spare = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        reactor->epoll = epoll_create1(EPOLL_CLOEXEC);
+        reactor->timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        timerfd_settime(reactor->timer, 0, &period, NULL);
+
+        struct epoll_event listenEvent = {EPOLLIN | EPOLLEXCLUSIVE, {.ptr = &listenerTag}};
+        struct epoll_event timerEvent = {EPOLLIN, {.ptr = &timerTag}};
+        epoll_ctl(reactor->epoll, EPOLL_CTL_ADD, listener, &listenEvent);
+        epoll_ctl(reactor->epoll, EPOLL_CTL_ADD, reactor->timer, &timerEvent);
+    }
+
+    if (server.socketPath != NULL) printf("Listening on %s with %d reactor(s)\n", server.socketPath, server.reactorCount);
+    else printf("Listening on 127.0.0.1:%d with %d reactor(s)\n", server.port, server.reactorCount);
+    fflush(stdout);
+
+    for (int r = 1; r < server.reactorCount; r++) pthread_create(&reactors[r].thread, NULL, reactorMain, &reactors[r]);
+    reactorMain(&reactors[0]);
+    return 0;
+}
@@ -0,0 +1,309 @@
+// Batch simulator: plays complete games headless on every core and reports,
+// for each difficulty, how they turned out. Used to balance GameConfig values.
+//
+//   crocs-sim [-n games] [-j threads] [-s seed] [-t ticks] [-p script] [map]
+//
+// Games are numbered and game i always plays the same difficulty with seed
+// (seed + i), so a run gives the same totals whatever the number of threads.
+
+#include "Game.h"
+#include <pthread.h>
+
+#define SIM_CONFIGS 8              // Map size x enemy count x enemy power
+#define SIM_DEFAULT_GAMES 10000
+#define SIM_DEFAULT_TICKS 20000    // A game still going after this many ticks is left unfinished
+#define SIM_MAX_THREADS 256
+#define SIM_MAX_SCRIPT 65536
+
+// How the simulated player picks its action every tick
+typedef struct SimPolicy {
+    Action* script;     // Actions played in a loop, or NULL for random play
+    int scriptLength;
+} SimPolicy;
+
+typedef struct SimStats {
+    long games;
+    long wins;              // Boss defeated
+    long portals;           // Games that reached the portal
+    long unfinished;
+    long long totalScore;
+    long long ticksToPortal;
+    long deaths[DAMAGE_CAUSE_COUNT];
+} SimStats;
+
+// Games still to play by a worker, as the range [next, end). The owner takes
+// games from the front; idle workers steal the back half.
+typedef struct SimQueue {
+    pthread_mutex_t lock;
+    long next;
+    long end;
+} SimQueue;
+
+typedef struct SimWorker {
+    int id;
+    struct SimRun* run;
+    SimQueue queue;
+    GameState* game;            // Reused for every game the worker plays
+    SimStats stats[SIM_CONFIGS];
+} SimWorker;
+
+typedef struct SimRun {
+    GameConfig configs[SIM_CONFIGS];
+    int configCount;
+    unsigned long long seed;
+    unsigned long maxTicks;
+    SimPolicy policy;
+    SimWorker* workers;
+    int workerCount;
+} SimRun;
+
+static const char* damageNames[DAMAGE_CAUSE_COUNT] = {"other", "crocodile", "snake", "thorns", "boss"};
+
+// Read a script of game keys, one action per tick: z/s/q/d move, f or c
+// followed by a direction shoot or break thorns, u and r use a health pack or
+// go back to a checkpoint, and '.' waits. Anything else is skipped.
+static int loadScript(const char* path, SimPolicy* policy) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return 0;
+
+    policy->script = (Action*)malloc(SIM_MAX_SCRIPT * sizeof(Action));
+    policy->scriptLength = 0;
+    int key, pending = 0;
+    while ((key = fgetc(file)) != EOF && policy->scriptLength < SIM_MAX_SCRIPT) {
+        Action action;
+        if (pending != 0) {
+            action = directionalAction(pending == 'f' ? ACTION_SHOOT_UP : ACTION_BREAK_UP, (char)key);
+            pending = 0;
+        } else if (key == 'f' || key == 'c') {
+            pending = key;
+            continue;
+        } else if (key == '.') {
+            action = ACTION_NONE;
+        } else {
+            action = actionFromKey((char)key);
+            if (action == ACTION_NONE || action == ACTION_QUIT) continue;
+        }
+        policy->script[policy->scriptLength++] = action;
+    }
+    fclose(file);
+    return policy->scriptLength > 0;
+}
+
+static Action nextAction(const SimPolicy* policy, GameRng* rng, unsigned long tick) {
+    if (policy->script != NULL) return policy->script[tick % policy->scriptLength];
+    // Any move, shot, thorn break or health pack, evenly
+    return (Action)(ACTION_MOVE_UP + rngNext(rng) % (ACTION_USE_HEALTH_PACK - ACTION_MOVE_UP + 1));
+}
+
+// Play one game to the end, through the boss arena if the portal is reached
+static void playGame(SimRun* run, GameState* game, const GameConfig* config, SimStats* stats) {
+    GameRng policyRng;
+    long portalTick = -1;
+
+    resetGame(game, config);
+    seedRng(&policyRng, config->seed ^ 0x9E3779B97F4A7C15ull);
+    while (game->tickCount < run->maxTicks) {
+        GameStatus status = gameStatus(game);
+        if (status == GAME_AT_PORTAL) {
+            if (portalTick < 0) portalTick = (long)game->tickCount;
+            gameStep(game, ACTION_ENTER_ARENA);
+            continue;
+        }
+        if (enterArenaIfReady(game)) continue;
+        if (isGameDone(game)) break;
+        gameStep(game, nextAction(&run->policy, &policyRng, game->tickCount));
+    }
+
+    GameStatus status = gameStatus(game);
+    stats->games++;
+    stats->totalScore += game->player.score;
+    if (portalTick >= 0) {
+        stats->portals++;
+        stats->ticksToPortal += portalTick;
+    }
+    if (status == GAME_BOSS_DEFEATED) stats->wins++;
+    else if (status == GAME_PLAYER_DEAD) stats->deaths[game->player.lastDamage]++;
+    else stats->unfinished++;
+}
+
+// Take the next game from a worker's own queue; -1 once it is empty
+static long takeGame(SimQueue* queue) {
+    long index = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->next < queue->end) index = queue->next++;
+    pthread_mutex_unlock(&queue->lock);
+    return index;
+}
+
+// Move the back half of another worker's games into our own queue.
+// Returns 0 when every other queue is empty, which means the run is over.
+static int stealGames(SimWorker* thief) {
+    SimRun* run = thief->run;
+    for (int offset = 1; offset < run->workerCount; offset++) {
+        SimQueue* victim = &run->workers[(thief->id + offset) % run->workerCount].queue;
+        long begin = 0, end = 0;
+
+        pthread_mutex_lock(&victim->lock);
+        long left = victim->end - victim->next;
+        if (left > 0) {
+            end = victim->end;
+            begin = end - (left + 1) / 2;
+            victim->end = begin;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if (end > begin) {
+            pthread_mutex_lock(&thief->queue.lock);
+            thief->queue.next = begin;
+            thief->queue.end = end;
+            pthread_mutex_unlock(&thief->queue.lock);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void* workerMain(void* argument) {
+    SimWorker* worker = (SimWorker*)argument;
+    SimRun* run = worker->run;
+
+    while (1) {
+        long index = takeGame(&worker->queue);
+        if (index < 0) {
+            if (!stealGames(worker)) break;
+            continue;
+        }
+        int slot = (int)(index % run->configCount);
+        GameConfig config = run->configs[slot];
+        config.seed = run->seed + (unsigned long long)index;
+        playGame(run, worker->game, &config, &worker->stats[slot]);
+    }
+    return NULL;
+}
+
+static void configLabel(const GameConfig* config, char* label, size_t size) {
+    const char* map = config->mapSize == SMALL_MAP ? "small" : config->mapSize == BIG_MAP ? "big" : "custom";
+    snprintf(label, size, "%s/%s/%s", map,
+             config->enemyCount == ENEMY_EASY ? "few" : "many",
+             config->enemyPower == POWER_WEAK ? "weak" : "strong");
+}
+
+static void printReport(SimRun* run) {
+    printf("%-20s %9s %6s %9s %8s %9s", "config", "games", "win%", "avg score", "portal%", "to portal");
+    for (int cause = 0; cause < DAMAGE_CAUSE_COUNT; cause++) printf(" %9s", damageNames[cause]);
+    printf(" %10s\n", "unfinished");
+
+    for (int slot = 0; slot < run->configCount; slot++) {
+        SimStats total;
+        memset(&total, 0, sizeof(total));
+        for (int w = 0; w < run->workerCount; w++) {
+            const SimStats* stats = &run->workers[w].stats[slot];
+            total.games += stats->games;
+            total.wins += stats->wins;
+            total.portals += stats->portals;
+            total.unfinished += stats->unfinished;
+            total.totalScore += stats->totalScore;
+            total.ticksToPortal += stats->ticksToPortal;
+            for (int cause = 0; cause < DAMAGE_CAUSE_COUNT; cause++) total.deaths[cause] += stats->deaths[cause];
+        }
+        if (total.games == 0) continue;
+
+        char label[32];
+        configLabel(&run->configs[slot], label, sizeof(label));
+        printf("%-20s %9ld %6.2f %9.1f %8.2f %9.1f", label, total.games,
+               100.0 * total.wins / total.games, (double)total.totalScore / total.games,
+               100.0 * total.portals / total.games,
+               total.portals > 0 ? (double)total.ticksToPortal / total.portals : 0.0);
+        for (int cause = 0; cause < DAMAGE_CAUSE_COUNT; cause++) printf(" %9ld", total.deaths[cause]);
+        printf(" %10ld\n", total.unfinished);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    SimRun run;
+    long games = SIM_DEFAULT_GAMES;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    char* customMap = NULL;
+    int opt;
+
+    memset(&run, 0, sizeof(run));
+    run.seed = 1;
+    run.maxTicks = SIM_DEFAULT_TICKS;
+    while ((opt = getopt(argc, argv, "n:j:s:t:p:")) != -1) {
+        switch (opt) {
+            case 'n': games = atol(optarg); break;
+            case 'j': threads = atol(optarg); break;
+            case 's': run.seed = strtoull(optarg, NULL, 10); break;
+            case 't': run.maxTicks = strtoul(optarg, NULL, 10); break;
+            case 'p':
+                if (!loadScript(optarg, &run.policy)) {
+                    fprintf(stderr, "Cannot load script %s\n", optarg);
+                    return 1;
+                }
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n games] [-j threads] [-s seed] [-t ticks] [-p script] [map]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (optind < argc) {
+        customMap = loadMapFile(argv[optind]);
+        if (customMap == NULL) {
+            fprintf(stderr, "Cannot load map %s (at most %dx%d cells)\n", argv[optind], MAX_MAP_SIZE, MAX_MAP_SIZE);
+            return 1;
+        }
+    }
+    if (games < 1) games = 1;
+    if (threads < 1) threads = 1;
+    if (threads > SIM_MAX_THREADS) threads = SIM_MAX_THREADS;
+
+    // Every difficulty the menu offers, on the custom map if one was given
+    for (int mapSize = SMALL_MAP; mapSize <= BIG_MAP; mapSize++) {
+        if (customMap != NULL && mapSize == BIG_MAP) break;
+        for (int enemyCount = ENEMY_EASY; enemyCount <= ENEMY_HARD; enemyCount++) {
+            for (int enemyPower = POWER_WEAK; enemyPower <= POWER_STRONG; enemyPower++) {
+                GameConfig* config = &run.configs[run.configCount++];
+                configureGame(config, mapSize, enemyCount, enemyPower);
+                if (customMap != NULL) {
+                    config->mapSize = CUSTOM_MAP;
+                    config->mapData = customMap;
+                }
+            }
+        }
+    }
+
+    // Deal the games out evenly; stealing evens out the long ones
+    run.workerCount = (int)threads;
+    run.workers = (SimWorker*)calloc(run.workerCount, sizeof(SimWorker));
+    pthread_t* handles = (pthread_t*)malloc(run.workerCount * sizeof(pthread_t));
+    for (int w = 0; w < run.workerCount; w++) {
+        SimWorker* worker = &run.workers[w];
+        worker->id = w;
+        worker->run = &run;
+        worker->game = (GameState*)calloc(1, sizeof(GameState));
+        strcpy(worker->game->player.name, "sim");
+        pthread_mutex_init(&worker->queue.lock, NULL);
+        worker->queue.next = games * w / run.workerCount;
+        worker->queue.end = games * (w + 1) / run.workerCount;
+    }
+
+    long long start = monotonicMs();
+    for (int w = 0; w < run.workerCount; w++) pthread_create(&handles[w], NULL, workerMain, &run.workers[w]);
+    for (int w = 0; w < run.workerCount; w++) pthread_join(handles[w], NULL);
+    long long elapsed = monotonicMs() - start;
+
+    printReport(&run);
+    fprintf(stderr, "%ld games on %d threads in %.2f s (%.0f games/s)\n", games, run.workerCount,
+            elapsed / 1000.0, elapsed > 0 ? games * 1000.0 / elapsed : 0.0);
+
+    for (int w = 0; w < run.workerCount; w++) {
+        cleanupGame(run.workers[w].game);
+        pthread_mutex_destroy(&run.workers[w].queue.lock);
+        free(run.workers[w].game);
+    }
+    free(run.workers);
+    free(handles);
+    free(run.policy.script);
+    free(customMap);
+    return 0;
+}